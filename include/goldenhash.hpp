@@ -27,19 +27,26 @@
 #include <map>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <algorithm>
 #include <random>
 #include <iomanip>
 #include <sstream>
 #include <vector>
 #include <string>
+#include <stdexcept>
 #include <iostream>
 #include <unordered_map>
+#include <memory>
+#include <span>
+#include <type_traits>
 
 // Platform-specific SIMD includes
+// The x86 vector kernels are built with per-function target attributes and
+// selected at runtime, so they do not depend on -march flags.
 #if defined(__x86_64__) || defined(_M_X64)
     #include <immintrin.h>
-    #define HAS_AVX2 __AVX2__
+    #define HAS_AVX2 1
 #elif defined(__aarch64__) || defined(_M_ARM64)
     #include <arm_neon.h>
     #define HAS_NEON 1
@@ -47,7 +54,9 @@
 
 namespace goldenhash {
 
-static const long double GOLDEN_RATIO = (1 + std::sqrt(5)) / 2;
+// (1 + sqrt(5)) / 2 evaluated in double precision, spelled out so that it is
+// usable in constant expressions
+inline constexpr long double GOLDEN_RATIO = 1.6180339887498949025257388711906969547271728515625L;
 
 
 /**
@@ -148,6 +157,465 @@ struct TestConfiguration {
     uint32_t avalanche_samples = 10000;
 };
 
+/**
+ * @enum SimdLevel
+ * @brief Instruction set used by the batched hashing kernels
+ */
+enum class SimdLevel {
+    Scalar,
+    AVX2,
+    AVX512,
+    NEON
+};
+
+/**
+ * @enum Reduction
+ * @brief How the final 64-bit hash value is mapped into the table range [0, N)
+ */
+enum class Reduction {
+    Modulo,     // h % N, the reference output
+    FastMod,    // Same values as Modulo, using a precomputed multiplier instead of a divide
+    FastRange   // (h * N) >> 64; no divide or 128-bit magic, but the values differ from Modulo
+};
+
+/**
+ * @struct SboxGeometry
+ * @brief Number and size of the compressive S-boxes
+ * @details The default of 8 S-boxes with 12-bit indices is 32 KB, a whole L1D
+ * on many cores. Fewer or narrower tables leave room for the caller's working
+ * set at some cost in mixing quality; sbox_test reports the tradeoff. Every
+ * word still takes 8 lookups, which cycle through however many S-boxes there are.
+ */
+struct SboxGeometry {
+    uint32_t num_sboxes = 8;    // 1, 2, 4 or 8
+    uint32_t index_bits = 12;   // 8 to 12; each S-box compresses index_bits to 8 bits
+
+    constexpr size_t sbox_size() const { return size_t(1) << index_bits; }
+    constexpr size_t bytes() const { return num_sboxes * sbox_size(); }
+    constexpr bool valid() const {
+        return (num_sboxes == 1 || num_sboxes == 2 || num_sboxes == 4 || num_sboxes == 8) &&
+               index_bits >= 8 && index_bits <= 12;
+    }
+    constexpr bool operator==(const SboxGeometry&) const = default;
+};
+
+/**
+ * @struct Hash128
+ * @brief Two 64-bit hash lanes produced by one pass over a key
+ */
+struct Hash128 {
+    uint64_t low;    // The value hash() reduces into [0, N)
+    uint64_t high;   // Second lane, finished from the input state independently of low
+};
+
+class GoldenHashState;
+
+namespace detail {
+
+// Compressive S-boxes for irreversibility: at most 8 S-boxes of 12-bit to
+// 8-bit, 4KB each; smaller geometries use a prefix of the same block
+inline constexpr size_t SBOX_SIZE = (1 << 12);
+inline constexpr size_t NUM_SBOXES = 8;
+
+/**
+ * @struct HashParameters
+ * @brief Everything derived from (N, seed) before the S-boxes are filled
+ */
+struct HashParameters {
+    uint64_t table_size;
+    uint64_t seed;
+    uint64_t prime_high;     // Prime near N/φ
+    uint64_t prime_low;      // Prime near N/φ²
+    uint64_t prime_product;
+    uint64_t prime_mod;
+    uint64_t working_mod;
+    uint64_t prime_mixed;    // Mixed prime for compression
+    uint64_t initial_hash;
+};
+
+/**
+ * @brief (a * b) mod m without overflow
+ */
+constexpr uint64_t mul_mod(uint64_t a, uint64_t b, uint64_t m) {
+    return static_cast<uint64_t>(static_cast<unsigned __int128>(a) * b % m);
+}
+
+/**
+ * @brief (base ^ exp) mod m by square-and-multiply
+ */
+constexpr uint64_t pow_mod(uint64_t base, uint64_t exp, uint64_t m) {
+    uint64_t result = 1 % m;
+    base %= m;
+    while (exp > 0) {
+        if (exp & 1) result = mul_mod(result, base, m);
+        base = mul_mod(base, base, m);
+        exp >>= 1;
+    }
+    return result;
+}
+
+/**
+ * @brief Deterministic primality test for any 64-bit value
+ * @details Trial division by the primes below 40, then Miller-Rabin with
+ * those 12 primes as witnesses, which has no false positives below 3.3 * 10^24.
+ * @param n Number to test
+ * @return True if n is prime, false otherwise
+ */
+constexpr bool is_prime(uint64_t n) {
+    constexpr uint64_t witnesses[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    if (n < 2) return false;
+    for (uint64_t p : witnesses) {
+        if (n % p == 0) return n == p;
+    }
+    if (n < 37 * 37) return true;
+    // n - 1 = d * 2^r with d odd
+    uint64_t d = n - 1;
+    int r = 0;
+    while ((d & 1) == 0) {
+        d >>= 1;
+        r++;
+    }
+    for (uint64_t a : witnesses) {
+        uint64_t x = pow_mod(a, d, n);
+        if (x == 1 || x == n - 1) continue;
+        bool composite = true;
+        for (int i = 1; i < r && composite; i++) {
+            x = mul_mod(x, x, n);
+            composite = x != n - 1;
+        }
+        if (composite) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Find the nearest prime to a target value
+ * @param target Target value to find prime near
+ * @return Nearest prime number, or target if none lies within 1000
+ */
+constexpr uint64_t find_nearest_prime(uint64_t target) {
+    // Search outward from target
+    for (uint64_t delta = 0; delta < 1000; delta++) {
+        if (target > delta && is_prime(target - delta)) return target - delta;
+        if (is_prime(target + delta)) return target + delta;
+    }
+    return target; // Fallback
+}
+
+/**
+ * @brief Derive the golden ratio primes and mixing constants for a table size
+ * @param N Table size
+ * @param seed Seed value
+ * @return Parameters shared by GoldenHash and GoldenHashFixed
+ * @throws std::invalid_argument if the table size derives a zero modulus
+ */
+constexpr HashParameters derive_parameters(uint64_t N, uint64_t seed) {
+    HashParameters p{};
+    p.table_size = N;
+    p.seed = seed;
+    // Find golden ratio primes
+    uint64_t target_high = N / GOLDEN_RATIO;
+    uint64_t target_low = N / (GOLDEN_RATIO * GOLDEN_RATIO);
+    p.prime_high = find_nearest_prime(target_high);
+    p.prime_low = find_nearest_prime(target_low);
+
+    // Mix using AND/OR operations with primes
+    p.prime_product = (p.prime_high * p.prime_low);
+    p.prime_mod = p.prime_product % N;
+    p.working_mod = (((N | p.prime_low) ^ (N & p.prime_high)) % (N << 4)) >> 4;
+    p.prime_mixed = (p.prime_product * (1 / GOLDEN_RATIO));
+    if (p.working_mod == 0 || p.prime_mod == 0) {
+        // N of 1-15 and 26-31; in a constant expression this is a compile error instead
+        throw std::invalid_argument("Unsupported table size: it derives a zero modulus (sizes from 32 up are supported)");
+    }
+
+    uint64_t h = ((N ^ p.prime_product) * seed) | (seed & 0xFFF);
+    h = (h * p.prime_product) ^ p.prime_mod;
+    h = (h * p.prime_low) ^ (p.prime_high);
+    h = (h & ~p.prime_mixed) | (((h ^ p.prime_product) >> 13) ^ p.working_mod);
+    h = ((h & p.prime_mixed) << 4) | (((h ^ p.prime_product) / p.working_mod) >> 4);
+    p.initial_hash = h;
+    return p;
+}
+
+/**
+ * @brief Fill the S-boxes for a set of parameters
+ * @param p Parameters from derive_parameters()
+ * @param sboxes geometry.bytes() bytes, S-box j starting at j * geometry.sbox_size()
+ * @param geometry Number and size of the S-boxes
+ */
+constexpr void generate_sboxes(const HashParameters& p, uint8_t* sboxes, SboxGeometry geometry = {}) {
+    uint64_t h = p.initial_hash;
+    const size_t size = geometry.sbox_size();
+    for (size_t j = 0; j < geometry.num_sboxes; j++) {
+        for (size_t i = 0; i < size; i++) {
+            h = (h * p.prime_product) ^ p.prime_mod;
+            sboxes[j * size + i] = ~((i ^ ((h & p.prime_low) ^ (h | p.prime_high))) ^ (h / p.prime_mod)) & 0xFF;
+        }
+    }
+}
+
+/**
+ * @struct MixConstants
+ * @brief Per-instance values the mixing functions read
+ */
+struct MixConstants {
+    const uint8_t* sboxes;   // sbox_mask + 1 tables of 2^index_bits bytes, back to back
+    uint64_t sbox_mask;      // Selector bits that pick an S-box
+    uint64_t index_mask;     // Index bits that pick an entry within one
+    uint64_t index_bits;
+    uint64_t prime_low;
+    uint64_t prime_high;
+    uint64_t prime_mixed;
+    uint64_t initial_hash;
+    uint64_t initial_state;
+};
+
+/**
+ * @brief Unaligned little-endian 64-bit load, also usable in constant expressions
+ */
+constexpr uint64_t load_word(const uint8_t* p) {
+    if (std::is_constant_evaluated()) {
+        uint64_t v = 0;
+        for (size_t i = 0; i < 8; i++) {
+            v |= static_cast<uint64_t>(p[i]) << (8 * i);
+        }
+        return v;
+    }
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+ * @brief Mix one 64-bit chunk of input using pre-selected S-boxes
+ * @param c Instance constants
+ * @param state Input mixing state
+ * @param h Running hash value
+ * @param tables The 8 S-boxes in lookup order
+ * @param chunk Next 8 bytes of input
+ */
+constexpr void mix_word(const MixConstants& c, uint64_t& state, uint64_t& h, const uint8_t* const* tables,
+                        uint64_t chunk) {
+    // Mix the 64-bit chunk into state
+    state ^= chunk;
+    state *= c.prime_low;
+    state ^= (state >> 17);
+    // Process all 8 bytes in parallel using S-boxes
+    uint64_t mixed = state ^ h;
+    // Extract 5 indices from the 12-bit fields of the 64-bit mixed value
+    const uint64_t m = c.index_mask;
+    uint8_t c1 = tables[0][mixed & m];
+    uint8_t c2 = tables[1][(mixed >> 12) & m];
+    uint8_t c3 = tables[2][(mixed >> 24) & m];
+    uint8_t c4 = tables[3][(mixed >> 36) & m];
+    uint8_t c5 = tables[4][(mixed >> 48) & m];
+    // For remaining indices, mix state differently
+    mixed = (state << 13) ^ (h >> 7);
+    uint8_t c6 = tables[5][mixed & m];
+    uint8_t c7 = tables[6][(mixed >> 12) & m];
+    uint8_t c8 = tables[7][(mixed >> 24) & m];
+    // Combine all compressed values
+    uint64_t compressed = ((uint64_t)c1 << 56) | ((uint64_t)c2 << 48) | 
+                         ((uint64_t)c3 << 40) | ((uint64_t)c4 << 32) |
+                         ((uint64_t)c5 << 24) | ((uint64_t)c6 << 16) | 
+                         ((uint64_t)c7 << 8) | c8;
+    h ^= compressed;
+    h *= c.prime_high;
+    h ^= (h >> 29);
+}
+
+/**
+ * @brief Resolve the S-boxes a word mixed at a given selector reads
+ * @param c Instance constants
+ * @param sbox_index Rotating S-box selector before the word
+ * @param tables Receives the S-boxes of the 8 lookups in lookup order
+ */
+constexpr void select_tables(const MixConstants& c, uint64_t sbox_index, const uint8_t** tables) {
+    for (size_t k = 0; k < NUM_SBOXES; k++) {
+        tables[k] = c.sboxes + ((++sbox_index & c.sbox_mask) << c.index_bits);
+    }
+}
+
+/**
+ * @brief Mix one 64-bit chunk of input into the running state
+ * @param c Instance constants
+ * @param state Input mixing state
+ * @param h Running hash value
+ * @param sbox_index Rotating S-box selector
+ * @param chunk Next 8 bytes of input
+ */
+constexpr void mix_word(const MixConstants& c, uint64_t& state, uint64_t& h, uint64_t& sbox_index, uint64_t chunk) {
+    const uint8_t* tables[NUM_SBOXES];
+    select_tables(c, sbox_index, tables);
+    sbox_index += NUM_SBOXES;
+    mix_word(c, state, h, tables, chunk);
+}
+
+/**
+ * @brief Mix a single trailing byte of input into the running state
+ * @param c Instance constants
+ * @param state Input mixing state
+ * @param h Running hash value
+ * @param sbox_index Rotating S-box selector
+ * @param ring The S-boxes of selector values 0-7, from select_tables(c, NUM_SBOXES - 1)
+ * @param byte Next byte of input
+ */
+constexpr void mix_byte(const MixConstants& c, uint64_t& state, uint64_t& h, uint64_t& sbox_index,
+                        const uint8_t* const* ring, uint8_t byte) {
+    // Mix input byte into state
+    state = (state << 8) | byte;
+    state *= c.prime_low;
+    state ^= (state >> 17);
+    // Use 3 S-box compressions per byte for irreversibility
+    uint8_t compressed1 = ring[++sbox_index & 7][(state ^ h) & c.index_mask];
+    uint8_t compressed2 = ring[++sbox_index & 7][((state >> 12) ^ (h >> 6)) & c.index_mask];
+    uint8_t compressed3 = ring[++sbox_index & 7][((state >> 24) ^ (h >> 18)) & c.index_mask];
+    h = (h << 24) | (compressed1 << 16) | (compressed2 << 8) | compressed3;
+    h ^= state;
+    h *= c.prime_high;
+    h ^= (h >> 29);
+}
+
+/**
+ * @brief Mix a single trailing byte of input into the running state
+ * @param c Instance constants
+ * @param state Input mixing state
+ * @param h Running hash value
+ * @param sbox_index Rotating S-box selector
+ * @param byte Next byte of input
+ */
+constexpr void mix_byte(const MixConstants& c, uint64_t& state, uint64_t& h, uint64_t& sbox_index, uint8_t byte) {
+    const uint8_t* ring[NUM_SBOXES];
+    select_tables(c, NUM_SBOXES - 1, ring);
+    mix_byte(c, state, h, sbox_index, ring, byte);
+}
+
+/**
+ * @brief Final avalanche of the running hash value
+ * @param c Instance constants
+ * @param h Running hash value
+ * @param len Length term folded into the avalanche
+ * @return Full 64-bit hash value
+ */
+constexpr uint64_t avalanche(const MixConstants& c, uint64_t h, size_t len) {
+    h ^= len * c.prime_mixed;
+    h ^= (h >> 33);
+    h *= c.prime_low;
+    h ^= (h >> 27);
+    return h;
+}
+
+/**
+ * @brief Second output lane from the final mixing state
+ * @details The first lane only sees h, so finishing the separate input state
+ * together with h gives a lane that collides independently of it.
+ * @param c Instance constants
+ * @param h Running hash value
+ * @param state Input mixing state
+ * @param len Length term folded into the avalanche
+ * @return Full 64-bit value of the second lane
+ */
+constexpr uint64_t avalanche_high(const MixConstants& c, uint64_t h, uint64_t state, size_t len) {
+    uint64_t x = state ^ ((h << 32) | (h >> 32)) ^ (len * c.prime_high);
+    // MurmurHash3's fmix64, whose multipliers do not depend on N
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/**
+ * @brief Mix a whole key, leaving the avalanche to the caller
+ * @param c Instance constants
+ * @param data Pointer to data to hash
+ * @param len Length of data in bytes
+ * @param h Receives the running hash value
+ * @param state Receives the input mixing state
+ * @return Length term for the avalanche
+ */
+constexpr size_t mix_input(const MixConstants& c, const uint8_t* data, size_t len, uint64_t& h, uint64_t& state) {
+    h = c.initial_hash;
+    state = c.initial_state;
+    size_t i = 0;
+    // Each word advances the selector by a full turn of the 8 S-boxes, so the
+    // lookup order only changes where the selector is re-derived from the state
+    const uint8_t* tables[NUM_SBOXES];
+    
+    // Process 32 bytes at a time
+    if (len >= 32) {
+        size_t chunks32 = len / 32;
+        uint64_t sbox_index = ~state;
+        select_tables(c, sbox_index, tables);
+        
+        for (size_t chunk = 0; chunk < chunks32; chunk++) {
+            // Prefetch next chunk's data
+            if (!std::is_constant_evaluated() && chunk + 1 < chunks32) {
+                __builtin_prefetch(data + (chunk + 1) * 32, 0, 3);
+            }
+            mix_word(c, state, h, tables, load_word(data + chunk * 32 + 0));
+            mix_word(c, state, h, tables, load_word(data + chunk * 32 + 8));
+            mix_word(c, state, h, tables, load_word(data + chunk * 32 + 16));
+            mix_word(c, state, h, tables, load_word(data + chunk * 32 + 24));
+            i += 32;
+        }
+        
+        // Update pointers for remaining data
+        data += i;
+        len -= i;
+        i = 0;
+    }
+    
+    // Process 8 bytes at a time
+    size_t len64 = len / 8;
+    uint64_t sbox_index = ~state;
+    select_tables(c, sbox_index, tables);
+    
+    for (size_t j = 0; j < len64; j++) {
+        mix_word(c, state, h, tables, load_word(data + j * 8));
+        i += 8;
+    }
+    // Process remaining bytes
+    if (i < len) {
+        const uint8_t* ring[NUM_SBOXES];
+        select_tables(c, NUM_SBOXES - 1, ring);
+        for (; i < len; i++) {
+            mix_byte(c, state, h, sbox_index, ring, data[i]);
+        }
+    }
+    return len;
+}
+
+/**
+ * @brief Hash a key to its full 64-bit value, before range reduction
+ * @param c Instance constants
+ * @param data Pointer to data to hash
+ * @param len Length of data in bytes
+ * @return Full 64-bit hash value
+ */
+constexpr uint64_t mix_bytes(const MixConstants& c, const uint8_t* data, size_t len) {
+    uint64_t h = 0, state = 0;
+    size_t tail = mix_input(c, data, len, h, state);
+    return avalanche(c, h, tail);
+}
+
+/**
+ * @brief Hash a key to two full 64-bit lanes, before range reduction
+ * @param c Instance constants
+ * @param data Pointer to data to hash
+ * @param len Length of data in bytes
+ * @return Both lanes; low equals mix_bytes()
+ */
+constexpr Hash128 mix_bytes_128(const MixConstants& c, const uint8_t* data, size_t len) {
+    uint64_t h = 0, state = 0;
+    size_t tail = mix_input(c, data, len, h, state);
+    return {avalanche(c, h, tail), avalanche_high(c, h, state, tail)};
+}
+
+} // namespace detail
+
 /**
  * @class GoldenHash
  * @brief Implementation of a modular golden ratio hash function
@@ -158,17 +626,47 @@ struct TestConfiguration {
  */
 class GoldenHash {    
 public:
+    /**
+     * @brief Smallest table size from which on every size is supported
+     * @details Below it some sizes (1-15 and 26-31) derive a zero modulus.
+     */
+    static constexpr uint64_t MIN_TABLE_SIZE = 32;
+
     /**
      * @brief Constructor for GoldenHash
      * @param table_size Size of the hash table
      * @param seed Seed value for the hash function (default: 0)
+     * @param reduction Mapping of the final value into [0, N) (default: Modulo)
+     * @param geometry Number and size of the S-boxes (default: 8 x 4 KB)
+     * @throws std::invalid_argument if the geometry is not valid() or the
+     * table size derives a zero modulus (see MIN_TABLE_SIZE)
      */
-    GoldenHash(uint64_t table_size, uint64_t seed = 0);
+    GoldenHash(uint64_t table_size, uint64_t seed = 0, Reduction reduction = Reduction::Modulo,
+               SboxGeometry geometry = {});
     
+    // The S-boxes are stored inline, so instances copy and move like plain values
+    GoldenHash(const GoldenHash&) = default;
+    GoldenHash& operator=(const GoldenHash&) = default;
+    GoldenHash(GoldenHash&&) noexcept = default;
+    GoldenHash& operator=(GoldenHash&&) noexcept = default;
+
     /**
-     * @brief Destructor - cleans up heap-allocated S-boxes
+     * @brief Get a process-wide shared instance for a configuration
+     * 
+     * Callers asking for the same (table_size, seed, reduction, geometry) while an
+     * earlier instance is still referenced get that same immutable object, so
+     * one copy of its S-boxes serves all of them. An entry is dropped once the
+     * last reference goes away. Safe to call from multiple threads.
+     * 
+     * @param table_size Size of the hash table
+     * @param seed Seed value for the hash function (default: 0)
+     * @param reduction Mapping of the final value into [0, N) (default: Modulo)
+     * @param geometry Number and size of the S-boxes (default: 8 x 4 KB)
+     * @return Shared instance
      */
-    ~GoldenHash();
+    static std::shared_ptr<const GoldenHash> shared(uint64_t table_size, uint64_t seed = 0,
+                                                    Reduction reduction = Reduction::Modulo,
+                                                    SboxGeometry geometry = {});
     
     /**
      * @brief Hash function
@@ -177,205 +675,109 @@ public:
      * @return Hash value in range [0, N)
      */
     inline uint64_t hash(const uint8_t* data, size_t len) const {
-        uint64_t h = initial_hash;
-        uint64_t state = seed_ ^ prime_product;
-        size_t i = 0;
-        
-#ifdef HAS_AVX2
-        // Process 32 bytes at a time with AVX2
-        if (len >= 32) {
-            const uint64_t* data64 = reinterpret_cast<const uint64_t*>(data);
-            size_t chunks32 = len / 32;
-            uint64_t sbox_index = ~state;
-            
-            for (size_t chunk = 0; chunk < chunks32; chunk++) {
-                // Prefetch next chunk's data and S-box entries
-                if (chunk + 1 < chunks32) {
-                    __builtin_prefetch(&data64[(chunk + 1) * 4], 0, 3);
-                    __builtin_prefetch(&sboxes[(sbox_index + 8) & 7][0], 0, 3);
-                }
-                
-                // Load 4x64-bit values
-                uint64_t v0 = data64[chunk * 4 + 0];
-                uint64_t v1 = data64[chunk * 4 + 1];
-                uint64_t v2 = data64[chunk * 4 + 2];
-                uint64_t v3 = data64[chunk * 4 + 3];
-                
-                // Process first 8 bytes
-                state ^= v0;
-                state *= prime_low;
-                state ^= (state >> 17);
-                
-                uint64_t mixed = state ^ h;
-                uint8_t c1 = sboxes[++sbox_index & 7][mixed & 0xFFF];
-                uint8_t c2 = sboxes[++sbox_index & 7][(mixed >> 12) & 0xFFF];
-                uint8_t c3 = sboxes[++sbox_index & 7][(mixed >> 24) & 0xFFF];
-                uint8_t c4 = sboxes[++sbox_index & 7][(mixed >> 36) & 0xFFF];
-                uint8_t c5 = sboxes[++sbox_index & 7][(mixed >> 48) & 0xFFF];
-                
-                mixed = (state << 13) ^ (h >> 7);
-                uint8_t c6 = sboxes[++sbox_index & 7][mixed & 0xFFF];
-                uint8_t c7 = sboxes[++sbox_index & 7][(mixed >> 12) & 0xFFF];
-                uint8_t c8 = sboxes[++sbox_index & 7][(mixed >> 24) & 0xFFF];
-                
-                uint64_t compressed1 = ((uint64_t)c1 << 56) | ((uint64_t)c2 << 48) | 
-                                      ((uint64_t)c3 << 40) | ((uint64_t)c4 << 32) |
-                                      ((uint64_t)c5 << 24) | ((uint64_t)c6 << 16) | 
-                                      ((uint64_t)c7 << 8) | c8;
-                
-                h ^= compressed1;
-                h *= prime_high;
-                h ^= (h >> 29);
-                
-                // Process second 8 bytes
-                state ^= v1;
-                state *= prime_low;
-                state ^= (state >> 17);
-                
-                mixed = state ^ h;
-                c1 = sboxes[++sbox_index & 7][mixed & 0xFFF];
-                c2 = sboxes[++sbox_index & 7][(mixed >> 12) & 0xFFF];
-                c3 = sboxes[++sbox_index & 7][(mixed >> 24) & 0xFFF];
-                c4 = sboxes[++sbox_index & 7][(mixed >> 36) & 0xFFF];
-                c5 = sboxes[++sbox_index & 7][(mixed >> 48) & 0xFFF];
-                
-                mixed = (state << 13) ^ (h >> 7);
-                c6 = sboxes[++sbox_index & 7][mixed & 0xFFF];
-                c7 = sboxes[++sbox_index & 7][(mixed >> 12) & 0xFFF];
-                c8 = sboxes[++sbox_index & 7][(mixed >> 24) & 0xFFF];
-                
-                uint64_t compressed2 = ((uint64_t)c1 << 56) | ((uint64_t)c2 << 48) | 
-                                      ((uint64_t)c3 << 40) | ((uint64_t)c4 << 32) |
-                                      ((uint64_t)c5 << 24) | ((uint64_t)c6 << 16) | 
-                                      ((uint64_t)c7 << 8) | c8;
-                
-                h ^= compressed2;
-                h *= prime_high;
-                h ^= (h >> 29);
-                
-                // Process third and fourth 8 bytes similarly
-                state ^= v2;
-                state *= prime_low;
-                state ^= (state >> 17);
-                
-                mixed = state ^ h;
-                c1 = sboxes[++sbox_index & 7][mixed & 0xFFF];
-                c2 = sboxes[++sbox_index & 7][(mixed >> 12) & 0xFFF];
-                c3 = sboxes[++sbox_index & 7][(mixed >> 24) & 0xFFF];
-                c4 = sboxes[++sbox_index & 7][(mixed >> 36) & 0xFFF];
-                c5 = sboxes[++sbox_index & 7][(mixed >> 48) & 0xFFF];
-                
-                mixed = (state << 13) ^ (h >> 7);
-                c6 = sboxes[++sbox_index & 7][mixed & 0xFFF];
-                c7 = sboxes[++sbox_index & 7][(mixed >> 12) & 0xFFF];
-                c8 = sboxes[++sbox_index & 7][(mixed >> 24) & 0xFFF];
-                
-                uint64_t compressed3 = ((uint64_t)c1 << 56) | ((uint64_t)c2 << 48) | 
-                                      ((uint64_t)c3 << 40) | ((uint64_t)c4 << 32) |
-                                      ((uint64_t)c5 << 24) | ((uint64_t)c6 << 16) | 
-                                      ((uint64_t)c7 << 8) | c8;
-                
-                h ^= compressed3;
-                h *= prime_high;
-                h ^= (h >> 29);
-                
-                // Process fourth 8 bytes
-                state ^= v3;
-                state *= prime_low;
-                state ^= (state >> 17);
-                
-                mixed = state ^ h;
-                c1 = sboxes[++sbox_index & 7][mixed & 0xFFF];
-                c2 = sboxes[++sbox_index & 7][(mixed >> 12) & 0xFFF];
-                c3 = sboxes[++sbox_index & 7][(mixed >> 24) & 0xFFF];
-                c4 = sboxes[++sbox_index & 7][(mixed >> 36) & 0xFFF];
-                c5 = sboxes[++sbox_index & 7][(mixed >> 48) & 0xFFF];
-                
-                mixed = (state << 13) ^ (h >> 7);
-                c6 = sboxes[++sbox_index & 7][mixed & 0xFFF];
-                c7 = sboxes[++sbox_index & 7][(mixed >> 12) & 0xFFF];
-                c8 = sboxes[++sbox_index & 7][(mixed >> 24) & 0xFFF];
-                
-                uint64_t compressed4 = ((uint64_t)c1 << 56) | ((uint64_t)c2 << 48) | 
-                                      ((uint64_t)c3 << 40) | ((uint64_t)c4 << 32) |
-                                      ((uint64_t)c5 << 24) | ((uint64_t)c6 << 16) | 
-                                      ((uint64_t)c7 << 8) | c8;
-                
-                h ^= compressed4;
-                h *= prime_high;
-                h ^= (h >> 29);
-                
-                i += 32;
-            }
-            
-            // Update pointers for remaining data
-            data += i;
-            len -= i;
-            i = 0;
-        }
-#endif
-        
-        // Process 8 bytes at a time (original code with prefetching)
-        const uint64_t* data64 = reinterpret_cast<const uint64_t*>(data);
-        size_t len64 = len / 8;
-        uint64_t sbox_index = ~state;
-        
-        for (size_t j = 0; j < len64; j++) {
-            // Prefetch next S-box entries
-            if (j + 1 < len64) {
-                __builtin_prefetch(&sboxes[(sbox_index + 1) & 7][0], 0, 1);
-            }
-            
-            uint64_t chunk = data64[j];
-            // Mix the 64-bit chunk into state
-            state ^= chunk;
-            state *= prime_low;
-            state ^= (state >> 17);
-            // Process all 8 bytes in parallel using S-boxes
-            uint64_t mixed = state ^ h;
-            // Extract 5 x 12-bit indices from the 64-bit mixed value
-            uint8_t c1 = sboxes[++sbox_index & 7][mixed & 0xFFF];
-            uint8_t c2 = sboxes[++sbox_index & 7][(mixed >> 12) & 0xFFF];
-            uint8_t c3 = sboxes[++sbox_index & 7][(mixed >> 24) & 0xFFF];
-            uint8_t c4 = sboxes[++sbox_index & 7][(mixed >> 36) & 0xFFF];
-            uint8_t c5 = sboxes[++sbox_index & 7][(mixed >> 48) & 0xFFF];
-            // For remaining indices, mix state differently
-            mixed = (state << 13) ^ (h >> 7);
-            uint8_t c6 = sboxes[++sbox_index & 7][mixed & 0xFFF];
-            uint8_t c7 = sboxes[++sbox_index & 7][(mixed >> 12) & 0xFFF];
-            uint8_t c8 = sboxes[++sbox_index & 7][(mixed >> 24) & 0xFFF];
-            // Combine all compressed values
-            uint64_t compressed = ((uint64_t)c1 << 56) | ((uint64_t)c2 << 48) | 
-                                 ((uint64_t)c3 << 40) | ((uint64_t)c4 << 32) |
-                                 ((uint64_t)c5 << 24) | ((uint64_t)c6 << 16) | 
-                                 ((uint64_t)c7 << 8) | c8;
-            h ^= compressed;
-            h *= prime_high;
-            h ^= (h >> 29);
-            i += 8;
-        }
-        // Process remaining bytes
-        for (; i < len; i++) {
-            // Mix input byte into state
-            state = (state << 8) | data[i];
-            state *= prime_low;
-            state ^= (state >> 17);
-            // Use 3 S-box compressions per byte for irreversibility
-            uint8_t compressed1 = sboxes[++sbox_index & 7][(state ^ h) & 0xFFF];
-            uint8_t compressed2 = sboxes[++sbox_index & 7][((state >> 12) ^ (h >> 6)) & 0xFFF];
-            uint8_t compressed3 = sboxes[++sbox_index & 7][((state >> 24) ^ (h >> 18)) & 0xFFF];
-            h = (h << 24) | (compressed1 << 16) | (compressed2 << 8) | compressed3;
-            h ^= state;
-            h *= prime_high;
-            h ^= (h >> 29);
+        return reduce(detail::mix_bytes(mix_constants(), data, len));
+    }
+
+    /**
+     * @brief Hash a batch of independent keys
+     * 
+     * Keys are processed in groups of BATCH_LANES interleaved lanes so that the
+     * S-box loads of different keys overlap instead of forming one long
+     * dependency chain. Results are identical to calling hash() on each key.
+     * 
+     * @param keys Array of n pointers to key data
+     * @param lens Array of n key lengths in bytes
+     * @param out Array of n hash values in range [0, N)
+     * @param n Number of keys
+     */
+    void hash_batch(const uint8_t* const* keys, const size_t* lens, uint64_t* out, size_t n) const;
+
+    /**
+     * @brief Hash a key to two independent 64-bit lanes in one pass
+     * @details The low lane is the value hash() reduces, so reduce(low) == hash().
+     * The high lane finishes the separate input state as well, so the two
+     * collide independently. Neither lane is reduced into [0, N).
+     * @param data Pointer to data to hash
+     * @param len Length of data in bytes
+     * @return Both 64-bit lanes
+     */
+    inline Hash128 hash128(const uint8_t* data, size_t len) const {
+        return detail::mix_bytes_128(mix_constants(), data, len);
+    }
+
+    /**
+     * @brief Derive k table indices from one pass over a key
+     * 
+     * Index i is reduce(low + i * high) over the lanes of hash128(), the
+     * Kirsch-Mitzenmacher double hashing scheme for Bloom filters and cuckoo
+     * tables. out[0] equals hash(). high is forced odd, so with Modulo or FastMod
+     * reduction the indices of a power-of-two table do not repeat before k reaches N.
+     * 
+     * @param data Pointer to data to hash
+     * @param len Length of data in bytes
+     * @param out Array of k hash values in range [0, N)
+     * @param k Number of indices
+     */
+    inline void hash_k(const uint8_t* data, size_t len, uint64_t* out, size_t k) const {
+        Hash128 lanes = hash128(data, len);
+        uint64_t step = lanes.high | 1;
+        uint64_t g = lanes.low;
+        for (size_t i = 0; i < k; i++, g += step) {
+            out[i] = reduce(g);
         }
-        // Final avalanche
-        h ^= len * prime_mixed;
-        h ^= (h >> 33);
-        h *= prime_low;
-        h ^= (h >> 27);
-        return h % N;
     }
+
+    /**
+     * @brief Get the kernel hash_batch() currently dispatches to
+     * @return Active SIMD level; defaults to the best x86 kernel the CPU supports
+     *         and to Scalar elsewhere
+     */
+    static SimdLevel simd_level();
+
+    /**
+     * @brief Select the kernel used by hash_batch()
+     * @param level Requested level, lowered to the best one the CPU supports
+     *        (a level from another architecture falls back to Scalar)
+     * @return The level now in effect
+     */
+    static SimdLevel set_simd_level(SimdLevel level);
+
+    /**
+     * @brief Get the printable name of a SIMD level
+     * @param level SIMD level
+     * @return Name such as "avx2"
+     */
+    static const char* simd_level_name(SimdLevel level);
+
+    /**
+     * @brief Get the printable name of a reduction mode
+     * @param reduction Reduction mode
+     * @return Name as accepted by parse_reduction()
+     */
+    static const char* reduction_name(Reduction reduction);
+
+    /**
+     * @brief Parse a reduction mode name
+     * @param name "modulo", "fastmod" or "fastrange"
+     * @return Reduction mode
+     * @throws std::invalid_argument if the name is unknown
+     */
+    static Reduction parse_reduction(const std::string& name);
+
+    /**
+     * @brief Get the printable name of an S-box geometry
+     * @param geometry S-box geometry
+     * @return Name such as "8x4k", as accepted by parse_sbox_geometry()
+     */
+    static std::string sbox_geometry_name(SboxGeometry geometry);
+
+    /**
+     * @brief Parse an S-box geometry name
+     * @param name "<count>x<size>" with the size in bytes, e.g. "2x4k", "8x1024" or "4x256"
+     * @return S-box geometry
+     * @throws std::invalid_argument if the name is malformed or the geometry is not valid()
+     */
+    static SboxGeometry parse_sbox_geometry(const std::string& name);
     
     /**
      * @brief Print information about the hash function configuration
@@ -423,6 +825,22 @@ public:
     uint64_t get_initial_hash() const {
         return initial_hash;
     }
+
+    /**
+     * @brief Get the reduction mode chosen at construction
+     * @return Reduction mode
+     */
+    Reduction get_reduction() const {
+        return reduction_;
+    }
+
+    /**
+     * @brief Get the S-box geometry chosen at construction
+     * @return S-box geometry
+     */
+    SboxGeometry get_sbox_geometry() const {
+        return geometry_;
+    }
     
     /**
      * @brief Get the factorization of the working modulus
@@ -436,23 +854,55 @@ public:
     void analyze_sboxes() const;
 
     /**
-     * @brief Runs a round of tests for a single table size
-     * @param table_size Size of the hash table to test
-     * @param num_tests Number of tests to run
-     * @return CollectiveMetrics containing the results of the tests
+     * @brief Generate the test keys used by run_tests_for()
+     * @details The keys are the same for every table size, so a sweep can
+     * generate them once and share them between all candidates.
+     * @param num_tests Number of keys
+     * @return Keys of 16-63 bytes from a fixed-seed generator
      */
-    static CollectiveMetrics run_tests_for(uint64_t table_size, uint64_t num_tests) {
-        GoldenHash hasher(table_size);
-        // Generate test data
+    static std::vector<std::vector<uint8_t>> generate_test_corpus(uint64_t num_tests) {
         std::mt19937_64 rng(42);
         std::vector<std::vector<uint8_t>> test_data;
+        test_data.reserve(num_tests);
         for (size_t i = 0; i < num_tests; i++) {
             std::vector<uint8_t> data(16 + (i % 48)); // Vary size 16-64 bytes
             for (auto& byte : data) {
                 byte = rng() & 0xFF;
             }
-            test_data.push_back(data);
+            test_data.push_back(std::move(data));
         }
+        return test_data;
+    }
+
+    /**
+     * @brief Runs a round of tests for a single table size
+     * @param table_size Size of the hash table to test
+     * @param num_tests Number of tests to run
+     * @return CollectiveMetrics containing the results of the tests
+     */
+    static CollectiveMetrics run_tests_for(uint64_t table_size, uint64_t num_tests) {
+        return run_tests_for(table_size, generate_test_corpus(num_tests));
+    }
+
+    /**
+     * @brief Runs a round of tests for a single table size on existing test keys
+     * @param table_size Size of the hash table to test
+     * @param test_data Keys from generate_test_corpus(), or a prefix of them
+     * @return CollectiveMetrics containing the results of the tests
+     */
+    static CollectiveMetrics run_tests_for(uint64_t table_size, std::span<const std::vector<uint8_t>> test_data) {
+        return run_tests_for(GoldenHash(table_size), test_data);
+    }
+
+    /**
+     * @brief Runs a round of tests for an existing hasher on existing test keys
+     * @param hasher Hasher to test; its table size, seed and reduction are used as they are
+     * @param test_data Keys from generate_test_corpus(), or a prefix of them
+     * @return CollectiveMetrics containing the results of the tests
+     */
+    static CollectiveMetrics run_tests_for(const GoldenHash& hasher, std::span<const std::vector<uint8_t>> test_data) {
+        uint64_t table_size = hasher.get_table_size();
+        uint64_t num_tests = test_data.size();
         // Hash and collect statistics, including avalanche
         std::vector<uint64_t> hash_counts(table_size, 0);
         size_t total_bit_changes = 0;
@@ -543,6 +993,7 @@ public:
         CollectiveMetrics metrics;
         metrics.table_size = table_size;
         metrics.unique_hashes = unique_hashes;
+        metrics.max_bucket_load = max_collisions;
         metrics.distribution_uniformity = std::sqrt(chi_square / table_size);
         metrics.total_collisions = total_collisions;
         metrics.expected_collisions = expected_collisions;
@@ -598,59 +1049,24 @@ public:
      * This function searches for the best hash table size based on the target size,
      * compares avalanche effect, collision rate, chi-square distribution, and
      * number of collisions vs. expected collisions based on the birthday paradox.
+     * The candidate sizes are tested in parallel on one shared set of test keys,
+     * and the winner is the same as for a sequential search.
      * 
      * @param target_size Target size for the hash table
+     * @param sizes_to_check Number of candidate sizes around the target (default: 1000)
      * @param multiple_of Multiple of which the table size should be a multiple of (default: 1)
-     * @param interations_to_search Number of iterations to search for the best table size (default: 100)
-     * @param seeds_to_check Number of different seeds to check for the best table size (default: 20)
+     * @param interations_to_search Number of test keys per candidate size (default: 20000)
+     * @param num_threads Number of worker threads, 0 for one per hardware thread (default: 0)
      */
     static void find_best_table_size(int64_t target_size,
                                      int64_t sizes_to_check = 1000,
                                      int64_t multiple_of = 1, 
-                                     int64_t interations_to_search = 20000) {
-        // Find a range between target_size where the modulus of the target size is == multiple_of, between -500 and +500 of target_size
-        CollectiveMetrics best_metrics;
-        bool value_collectd = false;
-        // Find a range between target_size where the modulus of the target size is == multiple_of, between -500 and +500 of target_size
-        int64_t halfway = sizes_to_check / 2 * multiple_of;
-        int64_t low_size = target_size - halfway;
-        int64_t high_size = target_size + halfway;
-        while (low_size % multiple_of != 0) {
-            low_size++;
-        }
-        while (high_size % multiple_of != 0) {
-            high_size++;
-        }
-        for (int64_t i = low_size; i <= high_size; i += multiple_of) {
-            if ((i < 500) || i > std::numeric_limits<int64_t>::max() - 500) {
-                std::cout << "Size is too small or too large for GoldenHash: " << i << "\n";
-                return;
-            }
-            CollectiveMetrics new_metrics = run_tests_for(i, interations_to_search);
-            if (!value_collectd || new_metrics.is_better_than(best_metrics)) {
-                best_metrics = new_metrics;
-                value_collectd = true;
-                std::cout << "New best metrics found for size " << i << ":\n";
-                std::cout << best_metrics.to_summary();
-            }
-        }
-        if (!value_collectd) {
-            std::cout << "No suitable table size found in the range.\n";
-        } else {
-            std::cout << "Best metrics found:\n";
-            std::cout << best_metrics.to_json() << "\n"
-                      << "Now running a full barage of tests on this final size.\n";
-            double speed = speed_test(best_metrics.table_size, 1000000);
-            std::cout << "Speed test for best size " << best_metrics.table_size << ": "
-                      << std::fixed << std::setprecision(8)
-                      << speed << " ns/hash\n";
-            CollectiveMetrics final_metrics = run_tests_for(best_metrics.table_size, 1000000);
-            std::cout << "Final metrics after full barrage:\n";
-            std::cout << final_metrics.to_json() << "\n";
-        }
-    }
+                                     int64_t interations_to_search = 20000,
+                                     size_t num_threads = 0);
 
 private:
+    friend class GoldenHashState;
+
     uint64_t N;              // Table size
     uint64_t prime_high;     // Prime near N/φ
     uint64_t prime_low;      // Prime near N/φ²
@@ -661,13 +1077,118 @@ private:
     uint64_t initial_hash;
     std::vector<uint64_t> factors;
     uint64_t seed_;          // Seed value
+    Reduction reduction_;
+    SboxGeometry geometry_;
+    unsigned __int128 fastmod_magic_;  // ceil(2^128 / N), for Reduction::FastMod
     
     // Compressive S-boxes for irreversibility
-    static constexpr size_t SBOX_SIZE = (1 << 12);  // 12-bit to 8-bit compression (4KB per S-box)
-    static constexpr size_t NUM_SBOXES = 8;
+    static constexpr size_t SBOX_SIZE = detail::SBOX_SIZE;  // 12-bit to 8-bit compression (4KB per S-box)
+    static constexpr size_t NUM_SBOXES = detail::NUM_SBOXES;
     
-    // Direct array allocation for better performance and cache locality
-    alignas(64) uint8_t* sboxes[NUM_SBOXES];
+    // All S-boxes live in one flat, cache-aligned block inside the object:
+    // S-box k starts at k * geometry_.sbox_size(), so a lookup needs no pointer
+    // load and vector gathers can address any table from a single base. A
+    // smaller geometry only ever touches the front of the block. The padding
+    // covers gathers that load a full word at the last index.
+    static constexpr size_t SBOX_PADDING = 64;
+    alignas(64) uint8_t sboxes[NUM_SBOXES * SBOX_SIZE + SBOX_PADDING];
+
+    // Number of keys hashed side by side in hash_batch()
+    static constexpr size_t BATCH_LANES = 8;
+    // Longer keys are not worth grouping and are hashed one at a time
+    static constexpr size_t BATCH_MAX_LENGTH = 128;
+
+    /**
+     * @brief Constants the shared mixing functions read
+     */
+    inline detail::MixConstants mix_constants() const {
+        return {sboxes, geometry_.num_sboxes - 1u, geometry_.sbox_size() - 1, geometry_.index_bits,
+                prime_low, prime_high, prime_mixed, initial_hash, seed_ ^ prime_product};
+    }
+
+    /**
+     * @brief Mix one 64-bit chunk of input into the running state
+     * @param state Input mixing state
+     * @param h Running hash value
+     * @param sbox_index Rotating S-box selector
+     * @param chunk Next 8 bytes of input
+     */
+    inline void mix_word(uint64_t& state, uint64_t& h, uint64_t& sbox_index, uint64_t chunk) const {
+        detail::mix_word(mix_constants(), state, h, sbox_index, chunk);
+    }
+
+    /**
+     * @brief Mix one 64-bit chunk of input using pre-selected S-boxes
+     * @param state Input mixing state
+     * @param h Running hash value
+     * @param tables The 8 S-boxes in lookup order
+     * @param chunk Next 8 bytes of input
+     */
+    inline void mix_word(uint64_t& state, uint64_t& h, const uint8_t* const* tables, uint64_t chunk) const {
+        detail::mix_word(mix_constants(), state, h, tables, chunk);
+    }
+
+    /**
+     * @brief Mix a single trailing byte of input into the running state
+     * @param state Input mixing state
+     * @param h Running hash value
+     * @param sbox_index Rotating S-box selector
+     * @param byte Next byte of input
+     */
+    inline void mix_byte(uint64_t& state, uint64_t& h, uint64_t& sbox_index, uint8_t byte) const {
+        detail::mix_byte(mix_constants(), state, h, sbox_index, byte);
+    }
+
+    /**
+     * @brief Final avalanche of the running hash value
+     * @param h Running hash value
+     * @param len Length term folded into the avalanche
+     * @return Full 64-bit hash value
+     */
+    inline uint64_t avalanche(uint64_t h, size_t len) const {
+        return detail::avalanche(mix_constants(), h, len);
+    }
+
+    /**
+     * @brief Reduce a full 64-bit hash value into the table range
+     * @param h Full 64-bit hash value
+     * @return Hash value in range [0, N)
+     */
+    inline uint64_t reduce(uint64_t h) const {
+        switch (reduction_) {
+            case Reduction::FastMod: {
+                // Lemire's fastmod: the fraction h/N scaled by 2^128, times N
+                unsigned __int128 fraction = fastmod_magic_ * h;
+                unsigned __int128 low = (static_cast<unsigned __int128>(static_cast<uint64_t>(fraction)) * N) >> 64;
+                return static_cast<uint64_t>((low + (fraction >> 64) * N) >> 64);
+            }
+            case Reduction::FastRange:
+                // The avalanche multiplies by prime_low, which is small for small N and
+                // leaves the top bits weak; a Fibonacci-hashing multiply by 2^64/φ
+                // spreads every bit into them before taking the high word of h * N.
+                h *= 0x9E3779B97F4A7C15ULL;
+                return static_cast<uint64_t>((static_cast<unsigned __int128>(h) * N) >> 64);
+            default:
+                return h % N;
+        }
+    }
+
+    /**
+     * @brief Hash BATCH_LANES keys of the same length in lock-step
+     * @param keys Key pointers of the whole batch
+     * @param len Length shared by the selected keys
+     * @param indices Batch indices of the BATCH_LANES selected keys
+     * @param out Hash values of the whole batch
+     */
+    void hash_lanes(const uint8_t* const* keys, size_t len, const size_t* indices, uint64_t* out) const;
+
+    /**
+     * @brief Portable lane kernel behind hash_lanes()
+     * @param data The BATCH_LANES keys
+     * @param len Length shared by the keys
+     * @param out Full 64-bit hash value of each lane
+     */
+    void mix_lanes(const uint8_t* const* data, size_t len, uint64_t* out) const;
 
     /**
      * @brief Simple primality test
@@ -691,4 +1212,104 @@ private:
     uint64_t find_nearest_prime(uint64_t target) const;
 };
 
+/**
+ * @class GoldenHashState
+ * @brief Incremental GoldenHash over data that arrives in pieces
+ *
+ * Feeding a key through any sequence of update() calls and then calling
+ * finalize() gives exactly the value GoldenHash::hash() returns for the
+ * concatenated bytes. hash() mixes whole 32-byte strides before it restarts
+ * the S-box selector for the rest, so up to 31 bytes are buffered between calls.
+ * The GoldenHash passed to the constructor must outlive the state.
+ */
+class GoldenHashState {
+public:
+    /**
+     * @brief Start an empty key
+     * @param hasher Hash function configuration to use
+     */
+    explicit GoldenHashState(const GoldenHash& hasher) : hasher_(&hasher) {
+        reset();
+    }
+
+    /**
+     * @brief Discard all input and start a new key
+     */
+    void reset() {
+        h_ = hasher_->initial_hash;
+        state_ = hasher_->seed_ ^ hasher_->prime_product;
+        sbox_index_ = ~state_;
+        fill_ = 0;
+    }
+
+    /**
+     * @brief Append bytes to the key
+     * @param data Pointer to the next bytes
+     * @param len Number of bytes
+     */
+    void update(const uint8_t* data, size_t len) {
+        if (len == 0) return;
+        if (fill_ > 0) {
+            size_t take = std::min(len, STRIDE - fill_);
+            std::memcpy(buffer_ + fill_, data, take);
+            fill_ += take;
+            data += take;
+            len -= take;
+            if (fill_ < STRIDE) return;
+            mix_stride(buffer_);
+            fill_ = 0;
+        }
+        for (; len >= STRIDE; data += STRIDE, len -= STRIDE) {
+            mix_stride(data);
+        }
+        if (len > 0) {
+            std::memcpy(buffer_, data, len);
+            fill_ = len;
+        }
+    }
+
+    /**
+     * @brief Hash of all bytes appended so far
+     * @details Does not change the state, so more data may still be appended.
+     * @return Hash value in range [0, N), equal to GoldenHash::hash() of the data
+     */
+    uint64_t finalize() const {
+        uint64_t state = state_;
+        uint64_t h = h_;
+        // hash() restarts the selector from the state after the 32-byte strides
+        uint64_t sbox_index = ~state;
+        size_t i = 0;
+        for (; i + 8 <= fill_; i += 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, buffer_ + i, sizeof(chunk));
+            hasher_->mix_word(state, h, sbox_index, chunk);
+        }
+        for (; i < fill_; i++) {
+            hasher_->mix_byte(state, h, sbox_index, buffer_[i]);
+        }
+        return hasher_->reduce(hasher_->avalanche(h, fill_));
+    }
+
+private:
+    static constexpr size_t STRIDE = 32;
+
+    /**
+     * @brief Mix one full 32-byte stride
+     */
+    inline void mix_stride(const uint8_t* data) {
+        for (size_t j = 0; j < STRIDE; j += 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, data + j, sizeof(chunk));
+            hasher_->mix_word(state_, h_, sbox_index_, chunk);
+        }
+    }
+
+    const GoldenHash* hasher_;
+    uint64_t state_;        // Input mixing state
+    uint64_t h_;            // Running hash value
+    uint64_t sbox_index_;   // Rotating S-box selector used by the strides
+    uint8_t buffer_[STRIDE];
+    size_t fill_;           // Bytes buffered in buffer_
+};
+
 } 
@@ -0,0 +1,156 @@
+/**
+ * Copyright 2025 Josh Morgan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file fixed.hpp
+ * @brief GoldenHash specialized at compile time for a fixed table size and seed
+ */
+
+#pragma once
+
+#include <goldenhash.hpp>
+
+#include <array>
+#include <string_view>
+
+namespace goldenhash {
+
+/**
+ * @class GoldenHashFixed
+ * @brief GoldenHash with the table size and seed fixed at compile time
+ *
+ * The golden ratio primes, mixing constants and S-boxes are computed during
+ * compilation and stored in read-only data, so there is no construction cost
+ * and no indirection through a heap block. Because N is a constant, the final
+ * `% N` compiles to a multiply and shift. hash() returns exactly
+ * GoldenHash(N, Seed, Reduction::Modulo, Geometry).hash() for the same input.
+ * Only Geometry.bytes() of S-boxes are emitted, so a reduced geometry also
+ * shrinks the read-only data.
+ *
+ * @tparam N Table size
+ * @tparam Seed Seed value for the hash function
+ * @tparam Geometry Number and size of the S-boxes
+ */
+template <uint64_t N, uint64_t Seed = 0, SboxGeometry Geometry = SboxGeometry{}>
+class GoldenHashFixed {
+public:
+    static_assert(N > 0, "GoldenHashFixed needs a non-zero table size");
+    static_assert(Geometry.valid(), "GoldenHashFixed needs 1, 2, 4 or 8 S-boxes with 8 to 12 index bits");
+
+    /**
+     * @brief Hash function
+     * @param data Pointer to data to hash
+     * @param len Length of data in bytes
+     * @return Hash value in range [0, N)
+     */
+    static constexpr uint64_t hash(const uint8_t* data, size_t len) {
+        return detail::mix_bytes(constants(), data, len) % N;
+    }
+
+    /**
+     * @brief Hash the bytes of a string
+     * @param key String to hash
+     * @return Hash value in range [0, N)
+     */
+    static constexpr uint64_t hash(std::string_view key) {
+        if (std::is_constant_evaluated()) {
+            // Constant evaluation cannot reinterpret char data as bytes
+            std::array<uint8_t, 256> buffer{};
+            if (key.size() <= buffer.size()) {
+                for (size_t i = 0; i < key.size(); i++) {
+                    buffer[i] = static_cast<uint8_t>(key[i]);
+                }
+                return hash(buffer.data(), key.size());
+            }
+        }
+        return hash(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+    }
+
+    /**
+     * @brief Hash a key to two independent 64-bit lanes in one pass
+     * @param data Pointer to data to hash
+     * @param len Length of data in bytes
+     * @return Both lanes, equal to GoldenHash::hash128() of the same configuration
+     */
+    static constexpr Hash128 hash128(const uint8_t* data, size_t len) {
+        return detail::mix_bytes_128(constants(), data, len);
+    }
+
+    /**
+     * @brief Derive k table indices from one pass over a key
+     * @param data Pointer to data to hash
+     * @param len Length of data in bytes
+     * @param out Array of k hash values in range [0, N), equal to GoldenHash::hash_k()
+     * @param k Number of indices
+     */
+    static constexpr void hash_k(const uint8_t* data, size_t len, uint64_t* out, size_t k) {
+        Hash128 lanes = hash128(data, len);
+        uint64_t step = lanes.high | 1;
+        uint64_t g = lanes.low;
+        for (size_t i = 0; i < k; i++, g += step) {
+            out[i] = g % N;
+        }
+    }
+
+    /**
+     * @brief Get the table size
+     * @return Table size N
+     */
+    static constexpr uint64_t get_table_size() { return N; }
+
+    /**
+     * @brief Get the high prime value
+     * @return Prime near N/φ
+     */
+    static constexpr uint64_t get_prime_high() { return params.prime_high; }
+
+    /**
+     * @brief Get the low prime value
+     * @return Prime near N/φ²
+     */
+    static constexpr uint64_t get_prime_low() { return params.prime_low; }
+
+    static constexpr uint64_t get_prime_mixed() { return params.prime_mixed; }
+
+    static constexpr uint64_t get_working_mod() { return params.working_mod; }
+
+    static constexpr uint64_t get_initial_hash() { return params.initial_hash; }
+
+private:
+    static constexpr detail::HashParameters params = detail::derive_parameters(N, Seed);
+
+    /**
+     * @brief Build the S-box tables during compilation
+     */
+    static constexpr std::array<uint8_t, Geometry.bytes()> make_sboxes() {
+        std::array<uint8_t, Geometry.bytes()> tables{};
+        detail::generate_sboxes(params, tables.data(), Geometry);
+        return tables;
+    }
+
+    alignas(64) static constexpr std::array<uint8_t, Geometry.bytes()> sboxes = make_sboxes();
+
+    /**
+     * @brief Constants the shared mixing functions read
+     */
+    static constexpr detail::MixConstants constants() {
+        return {sboxes.data(), Geometry.num_sboxes - 1u, Geometry.sbox_size() - 1, Geometry.index_bits,
+                params.prime_low, params.prime_high, params.prime_mixed,
+                params.initial_hash, Seed ^ params.prime_product};
+    }
+};
+
+} // namespace goldenhash
@@ -0,0 +1,244 @@
+/**
+ * @file baseline_hashes.hpp
+ * @brief Fast non-cryptographic hashes that GoldenHash is compared against
+ * @author Josh Morgan
+ * @date 2025
+ *
+ * Small self-contained ports of hashes that are not in third_party/:
+ * wyhash (final version 4, public domain, by Wang Yi), rapidhash (version 1,
+ * MIT licensed, by Nicolas De Carli), 64-bit FNV-1a and a hash built from
+ * AES-NI rounds. They produce full 64-bit values; reduction to a table size
+ * is left to the caller.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace goldenhash::tests::baseline {
+
+namespace detail {
+
+inline void mum(uint64_t* a, uint64_t* b) {
+    __uint128_t r = static_cast<__uint128_t>(*a) * *b;
+    *a = static_cast<uint64_t>(r);
+    *b = static_cast<uint64_t>(r >> 64);
+}
+
+inline uint64_t mix(uint64_t a, uint64_t b) {
+    mum(&a, &b);
+    return a ^ b;
+}
+
+inline uint64_t read64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline uint64_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+} // namespace detail
+
+/**
+ * @brief wyhash, final version 4, with its default secret
+ * @param data Input data
+ * @param len Length of input data
+ * @param seed Seed
+ * @return 64-bit hash
+ */
+inline uint64_t wyhash(const uint8_t* data, size_t len, uint64_t seed = 0) {
+    static constexpr uint64_t secret[4] = {
+        0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL
+    };
+    using detail::mix;
+    using detail::read32;
+    using detail::read64;
+    const uint8_t* p = data;
+    seed ^= mix(seed ^ secret[0], secret[1]);
+    uint64_t a, b;
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (read32(p) << 32) | read32(p + ((len >> 3) << 2));
+            b = (read32(p + len - 4) << 32) | read32(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i >= 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = mix(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+                see1 = mix(read64(p + 16) ^ secret[2], read64(p + 24) ^ see1);
+                see2 = mix(read64(p + 32) ^ secret[3], read64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = mix(read64(p) ^ secret[1], read64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = read64(p + i - 16);
+        b = read64(p + i - 8);
+    }
+    a ^= secret[1];
+    b ^= seed;
+    detail::mum(&a, &b);
+    return mix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+/**
+ * @brief rapidhash, version 1, with its default secret
+ * @param data Input data
+ * @param len Length of input data
+ * @param seed Seed, rapidhash's own default unless given
+ * @return 64-bit hash
+ */
+inline uint64_t rapidhash(const uint8_t* data, size_t len, uint64_t seed = 0xbdd89aa982704029ULL) {
+    static constexpr uint64_t secret[3] = {
+        0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL
+    };
+    using detail::mix;
+    using detail::read32;
+    using detail::read64;
+    const uint8_t* p = data;
+    seed ^= mix(seed ^ secret[0], secret[1]) ^ len;
+    uint64_t a, b;
+    if (len <= 16) {
+        if (len >= 4) {
+            const uint8_t* last = p + len - 4;
+            a = (read32(p) << 32) | read32(last);
+            const uint64_t delta = (len & 24) >> (len >> 3);
+            b = (read32(p + delta) << 32) | read32(last - delta);
+        } else if (len > 0) {
+            a = (static_cast<uint64_t>(p[0]) << 56) | (static_cast<uint64_t>(p[len >> 1]) << 32) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            while (i >= 96) {
+                seed = mix(read64(p) ^ secret[0], read64(p + 8) ^ seed);
+                see1 = mix(read64(p + 16) ^ secret[1], read64(p + 24) ^ see1);
+                see2 = mix(read64(p + 32) ^ secret[2], read64(p + 40) ^ see2);
+                seed = mix(read64(p + 48) ^ secret[0], read64(p + 56) ^ seed);
+                see1 = mix(read64(p + 64) ^ secret[1], read64(p + 72) ^ see1);
+                see2 = mix(read64(p + 80) ^ secret[2], read64(p + 88) ^ see2);
+                p += 96;
+                i -= 96;
+            }
+            if (i >= 48) {
+                seed = mix(read64(p) ^ secret[0], read64(p + 8) ^ seed);
+                see1 = mix(read64(p + 16) ^ secret[1], read64(p + 24) ^ see1);
+                see2 = mix(read64(p + 32) ^ secret[2], read64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            }
+            seed ^= see1 ^ see2;
+        }
+        if (i > 16) {
+            seed = mix(read64(p) ^ secret[2], read64(p + 8) ^ seed ^ secret[1]);
+            if (i > 32) {
+                seed = mix(read64(p + 16) ^ secret[2], read64(p + 24) ^ seed);
+            }
+        }
+        a = read64(p + i - 16);
+        b = read64(p + i - 8);
+    }
+    a ^= secret[1];
+    b ^= seed;
+    detail::mum(&a, &b);
+    return mix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+/**
+ * @brief 64-bit FNV-1a
+ * @param data Input data
+ * @param len Length of input data
+ * @return 64-bit hash
+ */
+inline uint64_t fnv1a_64(const uint8_t* data, size_t len) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Whether aes_hash() can run on this CPU
+ */
+inline bool aes_hash_supported() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return __builtin_cpu_supports("aes") && __builtin_cpu_supports("sse4.1");
+#else
+    return false;
+#endif
+}
+
+#if defined(__x86_64__) || defined(_M_X64)
+/**
+ * @brief Hash built from AES rounds; call only if aes_hash_supported()
+ * @details Every 16-byte block is xored into a 128-bit state that then goes
+ * through one AES round; a partial last block is read overlapping the previous
+ * one, or zero-padded for keys under 16 bytes, whose length is in the initial
+ * state. Three more rounds give every output bit a dependency on every input
+ * bit before the two halves are folded to 64 bits. Not a cryptographic MAC.
+ * @param data Input data
+ * @param len Length of input data
+ * @param seed Seed
+ * @return 64-bit hash
+ */
+__attribute__((target("aes,sse4.1")))
+inline uint64_t aes_hash(const uint8_t* data, size_t len, uint64_t seed = 0) {
+    const __m128i round_key = _mm_set_epi64x(0x243f6a8885a308d3LL, 0x13198a2e03707344LL);
+    __m128i state = _mm_set_epi64x(static_cast<long long>(seed ^ 0xa4093822299f31d0ULL),
+                                   static_cast<long long>(len ^ 0x082efa98ec4e6c89ULL));
+    const uint8_t* p = data;
+    size_t remaining = len;
+    while (remaining >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        state = _mm_aesenc_si128(_mm_xor_si128(state, block), round_key);
+        p += 16;
+        remaining -= 16;
+    }
+    if (remaining > 0) {
+        __m128i block;
+        if (len >= 16) {
+            block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + len - 16));
+        } else {
+            alignas(16) uint8_t padded[16] = {};
+            std::memcpy(padded, p, remaining);
+            block = _mm_load_si128(reinterpret_cast<const __m128i*>(padded));
+        }
+        state = _mm_aesenc_si128(_mm_xor_si128(state, block), round_key);
+    }
+    state = _mm_aesenc_si128(state, _mm_set_epi64x(0x452821e638d01377LL, static_cast<long long>(0xbe5466cf34e90c6cULL)));
+    state = _mm_aesenc_si128(state, _mm_set_epi64x(static_cast<long long>(0xc0ac29b7c97c50ddULL), 0x3f84d5b5b5470917LL));
+    state = _mm_aesenc_si128(state, round_key);
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(state)) ^ static_cast<uint64_t>(_mm_extract_epi64(state, 1));
+}
+#endif
+
+} // namespace goldenhash::tests::baseline
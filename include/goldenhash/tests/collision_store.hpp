@@ -14,6 +14,7 @@
 #include <vector>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <sqlite3.h>
 #include <sstream>
@@ -120,11 +121,13 @@ public:
 
 /**
  * @brief SQLite implementation of collision storage
+ * @details The store methods may be called from several threads; they share one connection under a mutex.
  */
 class SQLiteCollisionStore : public CollisionStore {
 private:
     std::string db_path_;
     sqlite3* db_ = nullptr;
+    std::mutex mutex_;
     
     // Prepared statements for performance
     sqlite3_stmt* insert_collision_stmt_ = nullptr;
@@ -233,22 +236,8 @@ public:
      * @return True on success
      */
     bool store_collision(const CollisionRecord& record) override {
-        if (!insert_collision_stmt_) return false;
-        
-        sqlite3_reset(insert_collision_stmt_);
-        sqlite3_bind_int64(insert_collision_stmt_, 1, record.hash_value);
-        sqlite3_bind_blob(insert_collision_stmt_, 2, record.input1.data(), 
-                         record.input1.size(), SQLITE_STATIC);
-        sqlite3_bind_blob(insert_collision_stmt_, 3, record.input2.data(), 
-                         record.input2.size(), SQLITE_STATIC);
-        sqlite3_bind_int64(insert_collision_stmt_, 4, record.input1_index);
-        sqlite3_bind_int64(insert_collision_stmt_, 5, record.input2_index);
-        sqlite3_bind_int64(insert_collision_stmt_, 6, record.timestamp);
-        sqlite3_bind_text(insert_collision_stmt_, 7, record.algorithm.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_int64(insert_collision_stmt_, 8, record.table_size);
-        sqlite3_bind_null(insert_collision_stmt_, 9); // run_id, can be set later
-        
-        return sqlite3_step(insert_collision_stmt_) == SQLITE_DONE;
+        std::lock_guard<std::mutex> lock(mutex_);
+        return insert_collision(record);
     }
     
     /**
@@ -257,12 +246,13 @@ public:
      * @return Number of records successfully stored
      */
     size_t store_collisions_batch(const std::vector<CollisionRecord>& records) override {
+        std::lock_guard<std::mutex> lock(mutex_);
         size_t stored = 0;
         
         sqlite3_exec(db_, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
         
         for (const auto& record : records) {
-            if (store_collision(record)) {
+            if (insert_collision(record)) {
                 stored++;
             }
         }
@@ -271,12 +261,38 @@ public:
         return stored;
     }
     
+private:
+    /**
+     * @brief Insert one collision; the caller holds the mutex
+     */
+    bool insert_collision(const CollisionRecord& record) {
+        if (!insert_collision_stmt_) return false;
+        
+        sqlite3_reset(insert_collision_stmt_);
+        sqlite3_bind_int64(insert_collision_stmt_, 1, record.hash_value);
+        sqlite3_bind_blob(insert_collision_stmt_, 2, record.input1.data(), 
+                         record.input1.size(), SQLITE_STATIC);
+        sqlite3_bind_blob(insert_collision_stmt_, 3, record.input2.data(), 
+                         record.input2.size(), SQLITE_STATIC);
+        sqlite3_bind_int64(insert_collision_stmt_, 4, record.input1_index);
+        sqlite3_bind_int64(insert_collision_stmt_, 5, record.input2_index);
+        sqlite3_bind_int64(insert_collision_stmt_, 6, record.timestamp);
+        sqlite3_bind_text(insert_collision_stmt_, 7, record.algorithm.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(insert_collision_stmt_, 8, record.table_size);
+        sqlite3_bind_null(insert_collision_stmt_, 9); // run_id, can be set later
+        
+        return sqlite3_step(insert_collision_stmt_) == SQLITE_DONE;
+    }
+    
+public:
+    
     /**
      * @brief Store test run with metrics
      * @param record Test run to store
      * @return True on success
      */
     bool store_test_run(const TestRunRecord& record) override {
+        std::lock_guard<std::mutex> lock(mutex_);
         if (!insert_test_run_stmt_) return false;
         
         sqlite3_reset(insert_test_run_stmt_);
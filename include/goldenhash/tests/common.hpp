@@ -5,8 +5,11 @@
 #include "map_shard.hpp"
 #include "sqlite_shard.hpp"
 #include "memory_utils.hpp"
+#include "perf_counters.hpp"
 #include "sqlite_test_data.hpp"
+#include "mmap_test_data.hpp"
 #include "test_data.hpp"
+#include "test_stream.hpp"
 #include <string>
 #include <cstdint>
 #include <iostream>
@@ -14,6 +17,8 @@
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <filesystem>
+#include <utility>
 
 namespace goldenhash::tests {
 
@@ -34,6 +39,9 @@ struct ComparisonResult {
     // Quality metrics
     double avalanche_score = 0.0;
     double avalanche_bias = 0.0;
+    double sac_bias = 0.0;              // RMS deviation of the SAC matrix from 0.5
+    double bic_max_correlation = 0.0;   // Largest correlation between two output bit changes
+    bool sac_collected = false;
     double chi_squared = 0.0;
     double uniformity_score = 0.0;
     double collision_ratio = 0.0;
@@ -41,6 +49,9 @@ struct ComparisonResult {
     double expected_collisions = 0.0;
     double load_factor = 0.0;
     bool metrics_collected = false;
+    // Hardware counters of the benchmark loop
+    PerfSample perf;
+    bool perf_collected = false;
 };
 
 /**
@@ -48,6 +59,20 @@ struct ComparisonResult {
  */
 class TestDataGenerator {
 public:
+    /**
+     * @brief Key indices [first, second) of one thread's share of the test data
+     * @param num_iterations Total number of keys
+     * @param num_threads Number of shares
+     * @param thread Share to return
+     */
+    static std::pair<size_t, size_t> partition(uint64_t num_iterations, int num_threads, int thread) {
+        size_t items_per_thread = num_iterations / num_threads;
+        size_t remainder = num_iterations % num_threads;
+        size_t start_idx = thread * items_per_thread + std::min(static_cast<size_t>(thread), remainder);
+        size_t end_idx = start_idx + items_per_thread + (thread < static_cast<int>(remainder) ? 1 : 0);
+        return {start_idx, end_idx};
+    }
+
     static std::vector<std::unique_ptr<TestData>> generate(
         uint64_t num_iterations,
         int num_threads,
@@ -61,18 +86,22 @@ public:
         std::vector<std::unique_ptr<TestData>> thread_test_data;
         thread_test_data.reserve(num_threads);
         
+        if (use_sqlite) {
+            std::filesystem::create_directories("data");
+        }
         for (int t = 0; t < num_threads; ++t) {
             if (use_sqlite) {
-                thread_test_data.push_back(std::make_unique<SQLiteTestData>("data/test_data_" + std::to_string(t) + ".db"));
+                // Corpora are kept between runs; the name identifies this thread's share
+                thread_test_data.push_back(std::make_unique<MmapTestData>(
+                    "data/test_data_" + std::to_string(num_iterations) + "_" + std::to_string(num_threads) +
+                    "_" + std::to_string(t) + ".bin"));
             } else {
-                thread_test_data.push_back(std::make_unique<InMemoryTestData>());
+                thread_test_data.push_back(std::make_unique<InMemoryTestData>(num_iterations / num_threads + 1));
             }
         }
         
         auto gen_start = std::chrono::high_resolution_clock::now();
         std::vector<std::thread> gen_threads;
-        size_t items_per_thread = num_iterations / num_threads;
-        size_t remainder = num_iterations % num_threads;
         
         std::atomic<size_t> threads_completed(0);
         
@@ -81,11 +110,20 @@ public:
         auto gen_start_time = std::chrono::high_resolution_clock::now();
         
         for (int t = 0; t < num_threads; ++t) {
-            size_t start_idx = t * items_per_thread + std::min(static_cast<size_t>(t), remainder);
-            size_t end_idx = start_idx + items_per_thread + (t < static_cast<int>(remainder) ? 1 : 0);
+            auto [start_idx, end_idx] = partition(num_iterations, num_threads, t);
             
             gen_threads.emplace_back([&, t, start_idx, end_idx]() {
-                create_test_data(thread_test_data[t].get(), start_idx, end_idx, &total_items_generated);
+                TestData* data = thread_test_data[t].get();
+                size_t existing = data->size();
+                if (existing == end_idx - start_idx) {
+                    // Reuse a corpus left by an earlier run
+                    total_items_generated.fetch_add(existing, std::memory_order_relaxed);
+                } else {
+                    if (existing > 0) {
+                        data->clean_up();
+                    }
+                    create_test_data(data, start_idx, end_idx, &total_items_generated);
+                }
                 threads_completed.fetch_add(1);
             });
         }
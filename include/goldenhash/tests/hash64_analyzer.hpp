@@ -15,7 +15,17 @@
 #include <memory>
 #include <string>
 #include <atomic>
-#include <unordered_set>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include <unistd.h>
 #include "collision_store.hpp"
 
 namespace goldenhash::tests {
@@ -26,72 +36,253 @@ namespace goldenhash::tests {
  * This class is designed to handle analysis of full 64-bit hash values
  * without modulo operations, providing insights into the true collision
  * characteristics of hash functions at scale.
+ *
+ * Collisions are counted exactly with an external radix sort. Hashes are
+ * buffered in memory; a full buffer is scattered by its top byte into 256
+ * spill files. finish() then counts each file on its own: a file that fits in
+ * memory is sorted and scanned, a larger one is split again by the next byte.
+ * Memory stays at a few buffers however many hashes are added; disk use is
+ * 8 bytes per hash. Runs that never fill the buffer do not touch the disk.
+ * add_hash() and add_hashes() may be called from several threads at once,
+ * e.g. by the runners of all partitions; everything else must not overlap
+ * with them.
  */
 class Hash64Analyzer {
 private:
-    std::unique_ptr<CollisionStore> collision_store_;
+    static constexpr size_t RADIX_BITS = 8;
+    static constexpr size_t RADIX = size_t{1} << RADIX_BITS;
+    static constexpr size_t BUFFER_HASHES = size_t{1} << 22;      // 32 MB of hashes before spilling
+    static constexpr size_t MAX_SORT_HASHES = size_t{1} << 25;    // Largest spill file sorted in memory (256 MB)
+
+    std::shared_ptr<CollisionStore> collision_store_;
     std::atomic<uint64_t> total_hashes_{0};
     std::atomic<uint64_t> unique_hashes_{0};
     std::atomic<uint64_t> actual_collisions_{0};
-    
-    // For memory efficiency, we use a probabilistic approach for very large datasets
-    static constexpr size_t SAMPLE_SIZE = 10000000;  // 10M samples
-    std::unique_ptr<std::unordered_set<uint64_t>> sample_set_;
-    bool use_sampling_ = false;
+
+    std::mutex mutex_;                    // Guards the buffer and the spill files while hashes are added
+    std::vector<uint64_t> buffer_;
+    std::filesystem::path spill_dir_;
+    std::filesystem::path run_dir_;       // Created on the first spill
+    std::vector<std::FILE*> spill_files_;
+    uint64_t spilled_hashes_ = 0;
+    bool finished_ = false;
+
+    static size_t digit(uint64_t hash, size_t level) {
+        return static_cast<size_t>((hash >> (64 - RADIX_BITS * (level + 1))) & (RADIX - 1));
+    }
+
+    static size_t count_unique_sorted(std::vector<uint64_t>& hashes) {
+        std::sort(hashes.begin(), hashes.end());
+        return static_cast<size_t>(std::unique(hashes.begin(), hashes.end()) - hashes.begin());
+    }
+
+    static std::FILE* open_file(const std::filesystem::path& path, const char* mode) {
+        std::FILE* file = std::fopen(path.c_str(), mode);
+        if (!file) {
+            throw std::runtime_error("Failed to open 64-bit hash spill file " + path.string() + ": " + std::strerror(errno));
+        }
+        return file;
+    }
+
+    /**
+     * @brief Scatter hashes by their digit at level into RADIX files
+     * @param hashes Hashes to write; reordered
+     * @param files One open file per digit
+     */
+    static void scatter(std::vector<uint64_t>& hashes, size_t level, const std::vector<std::FILE*>& files) {
+        std::array<size_t, RADIX + 1> starts{};
+        for (uint64_t hash : hashes) {
+            starts[digit(hash, level) + 1]++;
+        }
+        for (size_t d = 0; d < RADIX; ++d) {
+            starts[d + 1] += starts[d];
+        }
+        std::vector<uint64_t> sorted(hashes.size());
+        std::array<size_t, RADIX> next;
+        std::copy(starts.begin(), starts.begin() + RADIX, next.begin());
+        for (uint64_t hash : hashes) {
+            sorted[next[digit(hash, level)]++] = hash;
+        }
+        for (size_t d = 0; d < RADIX; ++d) {
+            size_t count = starts[d + 1] - starts[d];
+            if (count > 0 && std::fwrite(sorted.data() + starts[d], sizeof(uint64_t), count, files[d]) != count) {
+                throw std::runtime_error("Failed to write 64-bit hash spill file");
+            }
+        }
+    }
+
+    std::vector<std::FILE*> open_partition_files(const std::filesystem::path& dir) {
+        std::filesystem::create_directories(dir);
+        std::vector<std::FILE*> files;
+        files.reserve(RADIX);
+        try {
+            for (size_t d = 0; d < RADIX; ++d) {
+                files.push_back(open_file(dir / std::to_string(d), "w+b"));
+            }
+        } catch (...) {
+            for (std::FILE* file : files) std::fclose(file);
+            throw;
+        }
+        return files;
+    }
+
+    void spill() {
+        if (spill_files_.empty()) {
+            run_dir_ = spill_dir_ / ("goldenhash_hash64_" + std::to_string(::getpid()) + "_" +
+                                     std::to_string(reinterpret_cast<uintptr_t>(this)));
+            spill_files_ = open_partition_files(run_dir_);
+        }
+        scatter(buffer_, 0, spill_files_);
+        spilled_hashes_ += buffer_.size();
+        buffer_.clear();
+    }
+
+    /**
+     * @brief Count distinct values of a spill file whose hashes share their first level digits
+     */
+    uint64_t count_unique_file(std::FILE* file, const std::filesystem::path& path, size_t level) {
+        std::fseek(file, 0, SEEK_END);
+        uint64_t count = static_cast<uint64_t>(std::ftell(file)) / sizeof(uint64_t);
+        std::rewind(file);
+        if (count == 0) return 0;
+        if (level * RADIX_BITS >= 64) return 1;  // Every bit agrees: one value
+        if (count <= MAX_SORT_HASHES) {
+            std::vector<uint64_t> hashes(count);
+            if (std::fread(hashes.data(), sizeof(uint64_t), count, file) != count) {
+                throw std::runtime_error("Failed to read 64-bit hash spill file " + path.string());
+            }
+            return count_unique_sorted(hashes);
+        }
+        // Too large to sort in memory: split by the next digit and count the parts
+        std::filesystem::path dir = path.string() + ".split";
+        std::vector<std::FILE*> parts = open_partition_files(dir);
+        uint64_t unique = 0;
+        try {
+            std::vector<uint64_t> chunk;
+            chunk.resize(BUFFER_HASHES);
+            size_t read;
+            while ((read = std::fread(chunk.data(), sizeof(uint64_t), BUFFER_HASHES, file)) > 0) {
+                chunk.resize(read);
+                scatter(chunk, level, parts);
+                chunk.resize(BUFFER_HASHES);
+            }
+            for (size_t d = 0; d < RADIX; ++d) {
+                unique += count_unique_file(parts[d], dir / std::to_string(d), level + 1);
+            }
+        } catch (...) {
+            for (std::FILE* part : parts) std::fclose(part);
+            std::filesystem::remove_all(dir);
+            throw;
+        }
+        for (std::FILE* part : parts) std::fclose(part);
+        std::filesystem::remove_all(dir);
+        return unique;
+    }
+
+    void remove_spill_files() {
+        for (std::FILE* file : spill_files_) std::fclose(file);
+        spill_files_.clear();
+        if (!run_dir_.empty()) {
+            std::error_code ec;
+            std::filesystem::remove_all(run_dir_, ec);
+            run_dir_.clear();
+        }
+    }
     
 public:
     /**
      * @brief Constructor
      * @param collision_db_path Path to collision database (optional)
      * @param expected_hashes Expected number of hashes (for memory allocation)
+     * @param spill_dir Directory for spill files; empty for the system temporary directory
      */
     explicit Hash64Analyzer(const std::string& collision_db_path = "", 
-                           uint64_t expected_hashes = 0) {
-        if (!collision_db_path.empty()) {
-            collision_store_ = std::make_unique<SQLiteCollisionStore>(collision_db_path);
-            collision_store_->initialize();
-        }
-        
-        // Use sampling for very large datasets
-        if (expected_hashes > SAMPLE_SIZE * 10) {
-            use_sampling_ = true;
-            sample_set_ = std::make_unique<std::unordered_set<uint64_t>>();
-            sample_set_->reserve(SAMPLE_SIZE);
-        }
+                           uint64_t expected_hashes = 0, const std::string& spill_dir = "")
+        : Hash64Analyzer(open_store(collision_db_path), expected_hashes, spill_dir) {}
+
+    /**
+     * @brief Constructor that saves its results through an existing store
+     * @param collision_store Store shared with the caller, or nullptr to save nothing
+     * @param expected_hashes Expected number of hashes (for memory allocation)
+     * @param spill_dir Directory for spill files; empty for the system temporary directory
+     */
+    Hash64Analyzer(std::shared_ptr<CollisionStore> collision_store, uint64_t expected_hashes,
+                   const std::string& spill_dir = "")
+        : collision_store_(std::move(collision_store)) {
+        spill_dir_ = spill_dir.empty() ? std::filesystem::temp_directory_path() : std::filesystem::path(spill_dir);
+        buffer_.reserve(std::min<uint64_t>(std::max<uint64_t>(expected_hashes, 1), BUFFER_HASHES));
+    }
+
+    ~Hash64Analyzer() {
+        remove_spill_files();
     }
+
+    /**
+     * @brief Open and initialize a SQLite store, or nothing for an empty path
+     */
+    static std::shared_ptr<CollisionStore> open_store(const std::string& collision_db_path) {
+        if (collision_db_path.empty()) return nullptr;
+        auto store = std::make_shared<SQLiteCollisionStore>(collision_db_path);
+        store->initialize();
+        return store;
+    }
+
+    Hash64Analyzer(const Hash64Analyzer&) = delete;
+    Hash64Analyzer& operator=(const Hash64Analyzer&) = delete;
     
     /**
      * @brief Add a 64-bit hash value for analysis
+     * @details Collisions are only known once finish() has run.
      * @param hash_value Full 64-bit hash value
      * @param data Optional input data that produced this hash
      * @param data_len Length of input data
-     * @return True if this was a collision
      */
-    bool add_hash(uint64_t hash_value, const uint8_t* /*data*/ = nullptr, size_t /*data_len*/ = 0) {
-        total_hashes_++;
-        
-        if (use_sampling_) {
-            // Probabilistic sampling for very large datasets
-            if (sample_set_->size() < SAMPLE_SIZE) {
-                auto [it, inserted] = sample_set_->insert(hash_value);
-                if (inserted) {
-                    unique_hashes_++;
-                    return false;
-                } else {
-                    actual_collisions_++;
-                    return true;
-                }
+    void add_hash(uint64_t hash_value, const uint8_t* /*data*/ = nullptr, size_t /*data_len*/ = 0) {
+        add_hashes(std::span<const uint64_t>(&hash_value, 1));
+    }
+
+    /**
+     * @brief Add many 64-bit hash values under one lock
+     * @param hashes Full 64-bit hash values
+     */
+    void add_hashes(std::span<const uint64_t> hashes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (finished_) {
+            throw std::logic_error("Cannot add hashes to a finished 64-bit analysis");
+        }
+        total_hashes_ += hashes.size();
+        for (uint64_t hash_value : hashes) {
+            buffer_.push_back(hash_value);
+            if (buffer_.size() >= BUFFER_HASHES) {
+                spill();
             }
-            // After sample is full, use statistical estimation
-            return false;
+        }
+    }
+
+    /**
+     * @brief Count the distinct hashes and collisions of everything added
+     * @details Reads back and removes the spill files. Called by get_statistics()
+     * and save_results() if needed; no hashes can be added afterwards.
+     */
+    void finish() {
+        if (finished_) return;
+        uint64_t unique = 0;
+        if (spill_files_.empty()) {
+            unique = count_unique_sorted(buffer_);
         } else {
-            // For smaller datasets, track everything
-            // This would need a more sophisticated approach for production
-            // (e.g., bloom filters, hyperloglog, etc.)
-            return false;
+            if (!buffer_.empty()) spill();
+            for (size_t d = 0; d < RADIX; ++d) {
+                unique += count_unique_file(spill_files_[d], run_dir_ / std::to_string(d), 1);
+            }
+            remove_spill_files();
         }
+        buffer_.clear();
+        buffer_.shrink_to_fit();
+        unique_hashes_ = unique;
+        actual_collisions_ = total_hashes_.load() - unique;
+        finished_ = true;
     }
-    
+
     /**
      * @brief Get expected collisions for 64-bit hash space
      * @return Expected number of collisions based on birthday paradox
@@ -145,20 +336,19 @@ public:
      * @brief Get statistics about the analysis
      * @return String with formatted statistics
      */
-    std::string get_statistics() const {
+    std::string get_statistics() {
+        finish();
         std::stringstream ss;
         ss << "64-bit Hash Analysis Statistics:\n";
         ss << "  Total hashes: " << total_hashes_.load() << "\n";
         
-        if (use_sampling_) {
-            ss << "  Mode: Sampling (sample size: " << SAMPLE_SIZE << ")\n";
-            ss << "  Unique in sample: " << unique_hashes_.load() << "\n";
-            ss << "  Collisions in sample: " << actual_collisions_.load() << "\n";
+        if (spilled_hashes_ > 0) {
+            ss << "  Mode: Exact, external sort (" << spilled_hashes_ << " hashes spilled to disk)\n";
         } else {
-            ss << "  Mode: Full tracking\n";
-            ss << "  Unique hashes: " << unique_hashes_.load() << "\n";
-            ss << "  Actual collisions: " << actual_collisions_.load() << "\n";
+            ss << "  Mode: Exact, in memory\n";
         }
+        ss << "  Unique hashes: " << unique_hashes_.load() << "\n";
+        ss << "  Actual collisions: " << actual_collisions_.load() << "\n";
         
         ss << "  Expected collisions: " << std::fixed << std::setprecision(6) 
            << get_expected_collisions_64bit() << "\n";
@@ -176,8 +366,9 @@ public:
      */
     void save_results(const std::string& algorithm, const std::string& metadata = "{}") {
         if (!collision_store_) return;
+        finish();
         
-        TestRunRecord record;
+        TestRunRecord record{};
         record.run_id = generate_run_id(algorithm + "_64bit");
         record.algorithm = algorithm;
         record.table_size = 0;  // No table size for 64-bit analysis
@@ -1,66 +1,422 @@
 #pragma once
 
 #include <goldenhash.hpp>
+#include "baseline_hashes.hpp"
 #include <cstdint>
 #include <cstring>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
 #include "xxhash.h"
 #include <openssl/sha.h>
-#include <openssl/cmac.h>
 #include <openssl/evp.h>
+#include <openssl/params.h>
 
 namespace goldenhash::tests {
 
 /**
- * @brief Compute hash using the selected algorithm
- * @param algo_name Name of the algorithm
- * @param data Input data
- * @param len Length of input data
- * @param table_size Size of hash table for modulo operation
- * @param hasher GoldenHash instance (only used if algo_name is "goldenhash")
- * @return Hash value modulo table_size
+ * @brief Table size that asks HashAlgorithm::make() for the full 64-bit hash
+ * @details The baselines reduce modulo UINT64_MAX, which leaves their values
+ * practically unchanged; GoldenHash skips its reduction altogether.
+ */
+inline constexpr uint64_t FULL_HASH = UINT64_MAX;
+
+/**
+ * @brief GoldenHash through a shared instance, which reduces to its own table size
+ */
+class GoldenHashFunction {
+public:
+    /**
+     * @param hasher Shared instance
+     * @param reduced false for the unreduced 64-bit value, the low lane of GoldenHash::hash128()
+     */
+    explicit GoldenHashFunction(const GoldenHash& hasher, bool reduced = true)
+        : hasher_(&hasher), reduced_(reduced) {}
+
+    uint64_t operator()(const uint8_t* data, size_t len) {
+        return reduced_ ? hasher_->hash(data, len) : hasher_->hash128(data, len).low;
+    }
+
+    /**
+     * @brief Hash many keys at once, see GoldenHash::hash_batch()
+     */
+    void hash_batch(const uint8_t* const* keys, const size_t* lengths, uint64_t* out, size_t count) {
+        if (reduced_) {
+            hasher_->hash_batch(keys, lengths, out, count);
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                out[i] = hasher_->hash128(keys[i], lengths[i]).low;
+            }
+        }
+    }
+
+private:
+    const GoldenHash* hasher_;
+    bool reduced_;
+};
+
+/**
+ * @brief XXH64 with seed 0, reduced modulo the table size
  */
-inline uint64_t compute_hash(const std::string& algo_name, uint8_t* data, size_t len, 
-                            uint64_t table_size, GoldenHash& hasher) {
-    if (algo_name == "goldenhash") {
-        return hasher.hash(data, len);
-    } else if (algo_name == "xxhash64") {
-        return XXH64(data, len, 0) % table_size;
-    } else if (algo_name == "sha256") {
+class XXHash64Function {
+public:
+    explicit XXHash64Function(uint64_t table_size) : table_size_(table_size) {}
+
+    uint64_t operator()(const uint8_t* data, size_t len) {
+        return XXH64(data, len, 0) % table_size_;
+    }
+
+private:
+    uint64_t table_size_;
+};
+
+/**
+ * @brief A plain 64-bit hash function, reduced modulo the table size
+ * @tparam Hash Hash of (data, len)
+ */
+template <uint64_t (*Hash)(const uint8_t*, size_t)>
+class ReducedHashFunction {
+public:
+    explicit ReducedHashFunction(uint64_t table_size) : table_size_(table_size) {}
+
+    uint64_t operator()(const uint8_t* data, size_t len) {
+        return Hash(data, len) % table_size_;
+    }
+
+private:
+    uint64_t table_size_;
+};
+
+// Unseeded entry points of the baseline hashes, usable as ReducedHashFunction arguments
+namespace adapters {
+
+inline uint64_t xxh3_64(const uint8_t* data, size_t len) {
+    return XXH3_64bits(data, len);
+}
+
+// The low half, truncated like the digests of sha256 and aes-cmac
+inline uint64_t xxh3_128(const uint8_t* data, size_t len) {
+    return XXH3_128bits(data, len).low64;
+}
+
+inline uint64_t wyhash(const uint8_t* data, size_t len) {
+    return baseline::wyhash(data, len);
+}
+
+inline uint64_t rapidhash(const uint8_t* data, size_t len) {
+    return baseline::rapidhash(data, len);
+}
+
+inline uint64_t fnv1a(const uint8_t* data, size_t len) {
+    return baseline::fnv1a_64(data, len);
+}
+
+inline uint64_t aes_hash(const uint8_t* data, size_t len) {
+#if defined(__x86_64__) || defined(_M_X64)
+    return baseline::aes_hash(data, len);
+#else
+    (void)data;
+    (void)len;
+    throw std::runtime_error("aes-ni needs an x86-64 CPU");
+#endif
+}
+
+} // namespace adapters
+
+using Xxh3Function = ReducedHashFunction<adapters::xxh3_64>;
+using Xxh3_128Function = ReducedHashFunction<adapters::xxh3_128>;
+using WyhashFunction = ReducedHashFunction<adapters::wyhash>;
+using RapidhashFunction = ReducedHashFunction<adapters::rapidhash>;
+using Fnv1aFunction = ReducedHashFunction<adapters::fnv1a>;
+using AesHashFunction = ReducedHashFunction<adapters::aes_hash>;
+
+/**
+ * @brief First 64 bits of SHA-256, reduced modulo the table size
+ * @details The digest is fetched and its context created once; every hash only
+ * resets the context, instead of the fetch and allocation of the one-shot
+ * SHA256(). An instance must not be shared between threads.
+ */
+class Sha256Function {
+public:
+    /**
+     * @throws std::runtime_error if OpenSSL cannot provide SHA-256
+     */
+    explicit Sha256Function(uint64_t table_size) : table_size_(table_size) {
+        md_ = EVP_MD_fetch(NULL, "SHA256", NULL);
+        ctx_ = md_ ? EVP_MD_CTX_new() : nullptr;
+        if (!ctx_) {
+            release();
+            throw std::runtime_error("Failed to set up SHA-256");
+        }
+    }
+
+    Sha256Function(Sha256Function&& other) noexcept
+        : table_size_(other.table_size_),
+          md_(std::exchange(other.md_, nullptr)),
+          ctx_(std::exchange(other.ctx_, nullptr)) {}
+
+    Sha256Function& operator=(Sha256Function&& other) noexcept {
+        if (this != &other) {
+            release();
+            table_size_ = other.table_size_;
+            md_ = std::exchange(other.md_, nullptr);
+            ctx_ = std::exchange(other.ctx_, nullptr);
+        }
+        return *this;
+    }
+
+    Sha256Function(const Sha256Function&) = delete;
+    Sha256Function& operator=(const Sha256Function&) = delete;
+
+    ~Sha256Function() {
+        release();
+    }
+
+    uint64_t operator()(const uint8_t* data, size_t len) {
         unsigned char hash[SHA256_DIGEST_LENGTH];
-        SHA256(data, len, hash);
+        EVP_DigestInit_ex2(ctx_, md_, NULL);
+        EVP_DigestUpdate(ctx_, data, len);
+        EVP_DigestFinal_ex(ctx_, hash, NULL);
         uint64_t truncated = 0;
         memcpy(&truncated, hash, sizeof(uint64_t));
-        return truncated % table_size;
-    } else if (algo_name == "aes-cmac") {
-        // AES-128-CMAC
+        return truncated % table_size_;
+    }
+
+private:
+    void release() {
+        EVP_MD_CTX_free(ctx_);
+        EVP_MD_free(md_);
+        ctx_ = nullptr;
+        md_ = nullptr;
+    }
+
+    uint64_t table_size_;
+    EVP_MD* md_ = nullptr;
+    EVP_MD_CTX* ctx_ = nullptr;
+};
+
+/**
+ * @brief First 64 bits of AES-128-CMAC under a fixed key, reduced modulo the table size
+ * @details The MAC and its context are created and keyed once; every hash only
+ * resets the context, which keeps the expanded key. An instance must not be
+ * shared between threads.
+ */
+class AesCmacFunction {
+public:
+    /**
+     * @throws std::runtime_error if OpenSSL cannot provide AES-128-CBC CMAC
+     */
+    explicit AesCmacFunction(uint64_t table_size) : table_size_(table_size) {
         static const unsigned char key[16] = {
             0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
             0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
         };
-        
-        size_t mac_len = 16;
-        unsigned char mac[16];
-        
-        EVP_MAC *evp_mac = EVP_MAC_fetch(NULL, "CMAC", NULL);
-        EVP_MAC_CTX *ctx = EVP_MAC_CTX_new(evp_mac);
-        
+        mac_ = EVP_MAC_fetch(NULL, "CMAC", NULL);
+        ctx_ = mac_ ? EVP_MAC_CTX_new(mac_) : nullptr;
         OSSL_PARAM params[2];
         params[0] = OSSL_PARAM_construct_utf8_string("cipher", (char*)"AES-128-CBC", 0);
         params[1] = OSSL_PARAM_construct_end();
-        
-        EVP_MAC_init(ctx, key, 16, params);
-        EVP_MAC_update(ctx, data, len);
-        EVP_MAC_final(ctx, mac, &mac_len, sizeof(mac));
-        
-        EVP_MAC_CTX_free(ctx);
-        EVP_MAC_free(evp_mac);
-        
+        if (!ctx_ || !EVP_MAC_init(ctx_, key, sizeof(key), params)) {
+            release();
+            throw std::runtime_error("Failed to set up AES-128-CMAC");
+        }
+    }
+
+    AesCmacFunction(AesCmacFunction&& other) noexcept
+        : table_size_(other.table_size_),
+          mac_(std::exchange(other.mac_, nullptr)),
+          ctx_(std::exchange(other.ctx_, nullptr)) {}
+
+    AesCmacFunction& operator=(AesCmacFunction&& other) noexcept {
+        if (this != &other) {
+            release();
+            table_size_ = other.table_size_;
+            mac_ = std::exchange(other.mac_, nullptr);
+            ctx_ = std::exchange(other.ctx_, nullptr);
+        }
+        return *this;
+    }
+
+    AesCmacFunction(const AesCmacFunction&) = delete;
+    AesCmacFunction& operator=(const AesCmacFunction&) = delete;
+
+    ~AesCmacFunction() {
+        release();
+    }
+
+    uint64_t operator()(const uint8_t* data, size_t len) {
+        size_t mac_len = 16;
+        unsigned char mac[16];
+        // A null key restarts the MAC with the key already set
+        EVP_MAC_init(ctx_, NULL, 0, NULL);
+        EVP_MAC_update(ctx_, data, len);
+        EVP_MAC_final(ctx_, mac, &mac_len, sizeof(mac));
         uint64_t truncated = 0;
         memcpy(&truncated, mac, sizeof(uint64_t));
-        return truncated % table_size;
+        return truncated % table_size_;
+    }
+
+private:
+    void release() {
+        EVP_MAC_CTX_free(ctx_);
+        EVP_MAC_free(mac_);
+        ctx_ = nullptr;
+        mac_ = nullptr;
+    }
+
+    uint64_t table_size_;
+    EVP_MAC* mac_ = nullptr;
+    EVP_MAC_CTX* ctx_ = nullptr;
+};
+
+/**
+ * @brief A ready-to-call hash function of one of the registered algorithms
+ * @details Hot loops resolve the alternative once with std::visit and then
+ * call the concrete functor directly, so the per-key cost is the hash itself.
+ */
+using HashFunction = std::variant<GoldenHashFunction, XXHash64Function, Xxh3Function, Xxh3_128Function,
+                                  WyhashFunction, RapidhashFunction, Fnv1aFunction, AesHashFunction,
+                                  Sha256Function, AesCmacFunction>;
+
+/**
+ * @brief Registry entry describing one hash algorithm
+ */
+struct HashAlgorithm {
+    std::string_view name;
+
+    /**
+     * @brief Create a hash function reducing to table_size
+     * @details GoldenHash uses the hasher, which reduces to its own table size,
+     * unless table_size is FULL_HASH.
+     */
+    HashFunction (*make)(uint64_t table_size, const GoldenHash& hasher);
+
+    /**
+     * @brief Whether this machine can run the algorithm; make() throws if not
+     */
+    bool (*supported)() = [] { return true; };
+};
+
+/**
+ * @brief Every algorithm the tests can run, in the order --compare reports them
+ */
+inline std::span<const HashAlgorithm> hash_algorithms() {
+    static const HashAlgorithm registry[] = {
+        {"goldenhash", [](uint64_t table_size, const GoldenHash& hasher) -> HashFunction {
+            return GoldenHashFunction(hasher, table_size != FULL_HASH);
+        }},
+        {"xxhash64", [](uint64_t table_size, const GoldenHash&) -> HashFunction {
+            return XXHash64Function(table_size);
+        }},
+        {"xxh3", [](uint64_t table_size, const GoldenHash&) -> HashFunction {
+            return Xxh3Function(table_size);
+        }},
+        {"xxh3-128", [](uint64_t table_size, const GoldenHash&) -> HashFunction {
+            return Xxh3_128Function(table_size);
+        }},
+        {"wyhash", [](uint64_t table_size, const GoldenHash&) -> HashFunction {
+            return WyhashFunction(table_size);
+        }},
+        {"rapidhash", [](uint64_t table_size, const GoldenHash&) -> HashFunction {
+            return RapidhashFunction(table_size);
+        }},
+        {"fnv1a", [](uint64_t table_size, const GoldenHash&) -> HashFunction {
+            return Fnv1aFunction(table_size);
+        }},
+        {"aes-ni", [](uint64_t table_size, const GoldenHash&) -> HashFunction {
+            if (!baseline::aes_hash_supported()) {
+                throw std::runtime_error("aes-ni needs a CPU with AES-NI and SSE4.1");
+            }
+            return AesHashFunction(table_size);
+        }, baseline::aes_hash_supported},
+        {"sha256", [](uint64_t table_size, const GoldenHash&) -> HashFunction {
+            return Sha256Function(table_size);
+        }},
+        {"aes-cmac", [](uint64_t table_size, const GoldenHash&) -> HashFunction {
+            return HashFunction(std::in_place_type<AesCmacFunction>, table_size);
+        }},
+    };
+    return registry;
+}
+
+/**
+ * @brief Look up an algorithm by name
+ * @throws std::runtime_error if no algorithm has that name
+ */
+inline const HashAlgorithm& find_hash_algorithm(std::string_view name) {
+    for (const HashAlgorithm& algorithm : hash_algorithms()) {
+        if (algorithm.name == name) return algorithm;
+    }
+    throw std::runtime_error("Unknown algorithm: " + std::string(name));
+}
+
+/**
+ * @brief Hash many keys with one call
+ * @details Uses the function's own hash_batch() where it has one (GoldenHash
+ * interleaves the keys), otherwise hashes the keys in one loop.
+ * @param fn Hash function, one of the HashFunction alternatives
+ * @param keys Pointers to the keys
+ * @param lengths Length of every key
+ * @param out Receives count hashes
+ * @param count Number of keys
+ */
+template <typename Fn>
+inline void hash_batch(Fn& fn, const uint8_t* const* keys, const size_t* lengths, uint64_t* out, size_t count) {
+    if constexpr (requires { fn.hash_batch(keys, lengths, out, count); }) {
+        fn.hash_batch(keys, lengths, out, count);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = fn(keys[i], lengths[i]);
+        }
+    }
+}
+
+/**
+ * @brief Hash many keys with one call, whichever algorithm fn holds
+ */
+inline void hash_batch(HashFunction& fn, const uint8_t* const* keys, const size_t* lengths, uint64_t* out,
+                       size_t count) {
+    std::visit([&](auto& hash_fn) { hash_batch(hash_fn, keys, lengths, out, count); }, fn);
+}
+
+/**
+ * @brief Reusable buffers for compute_flip_hashes()
+ */
+struct FlipScratch {
+    std::vector<uint8_t> keys;
+    std::vector<const uint8_t*> pointers;
+    std::vector<size_t> lengths;
+};
+
+/**
+ * @brief Hash every single-bit flip of a key
+ * @details The 8 * len variants are written back to back into the scratch
+ * buffer and hashed with one hash_batch() call.
+ * @param fn Hash function, one of the HashFunction alternatives
+ * @param data Input data
+ * @param len Length of input data
+ * @param out Receives 8 * len hashes; out[i] is the hash with bit i % 8 of byte i / 8 flipped
+ * @param scratch Buffers reused between calls
+ */
+template <typename Fn>
+inline void compute_flip_hashes(Fn& fn, const uint8_t* data, size_t len, uint64_t* out,
+                                FlipScratch& scratch) {
+    size_t count = 8 * len;
+    if (count == 0) return;
+    scratch.keys.resize(count * len);
+    scratch.pointers.resize(count);
+    scratch.lengths.assign(count, len);
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t* key = scratch.keys.data() + i * len;
+        std::memcpy(key, data, len);
+        key[i / 8] ^= static_cast<uint8_t>(1u << (i % 8));
+        scratch.pointers[i] = key;
     }
-    throw std::runtime_error("Unknown algorithm: " + algo_name);
+    hash_batch(fn, scratch.pointers.data(), scratch.lengths.data(), out, count);
 }
 
-} // namespace goldenhash
+} // namespace goldenhash::tests
@@ -2,7 +2,12 @@
 
 #include <unordered_map>
 #include <map>
+#include <algorithm>
 #include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <thread>
 
 namespace goldenhash::tests {
@@ -45,4 +50,118 @@ public:
     }
 };
 
+/**
+ * @brief Lock-free open-addressing counting shard
+ *
+ * A flat array of (key, count) slots sized up front, probed linearly from a
+ * Fibonacci hash of the key. Threads claim empty slots with a CAS and count
+ * with fetch_add, so there is no lock and no allocation per key; the cost
+ * measured is that of the table itself. Key 0 marks an empty slot, so hash 0
+ * is counted separately. A key that finds no free slot within MAX_PROBES of
+ * its home slot, e.g. because the table was sized too small, goes to a locked
+ * overflow map instead of being lost.
+ */
+class FlatCountingShard : public MapShard {
+private:
+    struct Slot {
+        std::atomic<uint64_t> key{0};
+        std::atomic<uint64_t> count{0};
+    };
+
+    // Slots never become empty again, so a lookup that reaches an empty slot
+    // or the probe limit knows where the key must be
+    static constexpr size_t MAX_PROBES = 256;
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t capacity_;
+    int shift_;
+    std::atomic<uint64_t> zero_count_{0};
+    std::mutex overflow_mutex_;
+    std::unordered_map<uint64_t, uint64_t> overflow_;
+
+    size_t home_slot(uint64_t hash) const {
+        return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ULL) >> shift_);
+    }
+
+public:
+    /**
+     * @brief Allocate the slot array
+     * @param expected_keys Number of distinct keys this shard should hold; the
+     * table gets at least twice as many slots, rounded up to a power of two
+     */
+    explicit FlatCountingShard(uint64_t expected_keys)
+        : capacity_(std::bit_ceil<uint64_t>(std::max<uint64_t>(expected_keys * 2, 64))),
+          shift_(64 - std::countr_zero(capacity_)) {
+        slots_ = std::make_unique<Slot[]>(capacity_);
+    }
+    FlatCountingShard(const FlatCountingShard&) = delete;
+    FlatCountingShard& operator=(const FlatCountingShard&) = delete;
+
+    void process_hash(uint64_t hash) override {
+        if (hash == 0) {
+            zero_count_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        size_t mask = capacity_ - 1;
+        size_t slot = home_slot(hash);
+        size_t probes = std::min(capacity_, MAX_PROBES);
+        for (size_t probe = 0; probe < probes; probe++) {
+            Slot& s = slots_[slot];
+            uint64_t key = s.key.load(std::memory_order_acquire);
+            if (key == 0) {
+                // On failure key receives the winner, which may be this very hash
+                if (s.key.compare_exchange_strong(key, hash, std::memory_order_acq_rel)) {
+                    s.count.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+            if (key == hash) {
+                s.count.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            slot = (slot + 1) & mask;
+        }
+        std::lock_guard<std::mutex> lock(overflow_mutex_);
+        overflow_[hash]++;
+    }
+
+    /**
+     * @brief Number of times a hash was processed
+     * @details Not synchronized with concurrent process_hash() calls.
+     */
+    uint64_t get_count(uint64_t hash) {
+        if (hash == 0) return zero_count_.load();
+        size_t mask = capacity_ - 1;
+        size_t slot = home_slot(hash);
+        size_t probes = std::min(capacity_, MAX_PROBES);
+        for (size_t probe = 0; probe < probes; probe++) {
+            uint64_t key = slots_[slot].key.load();
+            if (key == hash) return slots_[slot].count.load();
+            if (key == 0) return 0;
+            slot = (slot + 1) & mask;
+        }
+        std::lock_guard<std::mutex> lock(overflow_mutex_);
+        auto it = overflow_.find(hash);
+        return it == overflow_.end() ? 0 : it->second;
+    }
+
+    /**
+     * @brief Number of distinct hashes processed
+     * @details Not synchronized with concurrent process_hash() calls.
+     */
+    uint64_t unique_hashes() {
+        uint64_t unique = zero_count_.load() > 0 ? 1 : 0;
+        for (size_t i = 0; i < capacity_; i++) {
+            if (slots_[i].key.load(std::memory_order_relaxed) != 0) unique++;
+        }
+        std::lock_guard<std::mutex> lock(overflow_mutex_);
+        return unique + overflow_.size();
+    }
+
+    /**
+     * @brief Number of slots in the flat table
+     */
+    size_t capacity() const { return capacity_; }
+};
+
 } // namespace goldenhash
@@ -6,6 +6,9 @@
  * 
  * Provides classes for analyzing hash function quality metrics including
  * avalanche effect, chi-squared distribution, and collision analysis.
+ * Every collector can merge() another one of the same shape, so each worker
+ * can analyze its own partition of the test data and the results are reduced
+ * at the end.
  */
 
 #pragma once
@@ -17,7 +20,10 @@
 #include <unordered_map>
 #include <algorithm>
 #include <numeric>
+#include <atomic>
 #include <bitset>
+#include <memory>
+#include <stdexcept>
 
 namespace goldenhash::tests {
 
@@ -26,21 +32,95 @@ namespace goldenhash::tests {
  * 
  * The avalanche effect measures how many output bits change when a single
  * input bit is flipped. Ideal value is 0.5 (50% of bits change).
+ *
+ * add_flips() takes the hashes of all single-bit flips of a key at once and
+ * counts the changed output bits with bit-sliced counters, one counter bit
+ * per plane, so a difference word costs a few logic operations instead of a
+ * loop over the output bits. With matrix_input_bits > 0 the analyzer also
+ * keeps the input-by-output change matrix for the strict avalanche criterion
+ * (SAC) and the pairwise output changes for the bit independence criterion (BIC).
  */
 class AvalancheAnalyzer {
 private:
+    // Bit-sliced counters: plane p holds bit p of the count of every output bit
+    static constexpr size_t PLANES = 8;
+    static constexpr size_t MAX_PENDING = (size_t{1} << PLANES) - 1;
+
     size_t output_bits_;
     size_t total_tests_ = 0;
     size_t total_bit_changes_ = 0;
-    std::vector<double> bit_change_probabilities_;
+    std::vector<size_t> bit_change_counts_;
+    uint64_t planes_[PLANES] = {};
+    size_t pending_ = 0;  // Differences held in planes_
+
+    size_t matrix_input_bits_;
+    std::vector<size_t> sac_counts_;      // [input bit][output bit] changes
+    std::vector<size_t> sac_samples_;     // Flips seen per input bit
+    std::vector<size_t> pair_counts_;     // [output bit][output bit] joint changes, upper triangle
+
+    uint64_t output_mask() const {
+        return output_bits_ >= 64 ? ~0ULL : (1ULL << output_bits_) - 1;
+    }
+
+    /**
+     * @brief Move the bit-sliced counts into bit_change_counts_
+     */
+    void flush_planes() {
+        if (pending_ == 0) return;
+        for (size_t p = 0; p < PLANES; ++p) {
+            uint64_t plane = planes_[p];
+            while (plane) {
+                bit_change_counts_[__builtin_ctzll(plane)] += size_t{1} << p;
+                plane &= plane - 1;
+            }
+            planes_[p] = 0;
+        }
+        pending_ = 0;
+    }
+
+    void count_difference(uint64_t diff) {
+        total_bit_changes_ += __builtin_popcountll(diff);
+        total_tests_++;
+        // Add one to the counter of every set bit: a ripple-carry add across the planes
+        uint64_t carry = diff;
+        for (size_t p = 0; carry && p < PLANES; ++p) {
+            uint64_t next = planes_[p] & carry;
+            planes_[p] ^= carry;
+            carry = next;
+        }
+        if (++pending_ == MAX_PENDING) {
+            flush_planes();
+        }
+    }
+
+    void count_matrix(size_t input_bit, uint64_t diff) {
+        if (input_bit >= matrix_input_bits_) return;
+        sac_samples_[input_bit]++;
+        size_t* row = &sac_counts_[input_bit * output_bits_];
+        for (uint64_t bits = diff; bits; bits &= bits - 1) {
+            size_t j = __builtin_ctzll(bits);
+            row[j]++;
+            for (uint64_t rest = bits & (bits - 1); rest; rest &= rest - 1) {
+                pair_counts_[j * output_bits_ + __builtin_ctzll(rest)]++;
+            }
+        }
+    }
 
 public:
     /**
      * @brief Constructor
      * @param output_bits Number of bits in hash output to analyze
+     * @param matrix_input_bits Input bits covered by the SAC/BIC matrices, 0 to disable them
      */
-    explicit AvalancheAnalyzer(size_t output_bits = 64) 
-        : output_bits_(output_bits), bit_change_probabilities_(output_bits, 0.0) {}
+    explicit AvalancheAnalyzer(size_t output_bits = 64, size_t matrix_input_bits = 0) 
+        : output_bits_(std::min<size_t>(output_bits, 64)), bit_change_counts_(output_bits_, 0),
+          matrix_input_bits_(matrix_input_bits) {
+        if (matrix_input_bits_ > 0) {
+            sac_counts_.assign(matrix_input_bits_ * output_bits_, 0);
+            sac_samples_.assign(matrix_input_bits_, 0);
+            pair_counts_.assign(output_bits_ * output_bits_, 0);
+        }
+    }
 
     /**
      * @brief Analyze avalanche effect between two hash values
@@ -48,19 +128,48 @@ public:
      * @param hash2 Second hash value (should differ by 1 bit in input)
      */
     void add_sample(uint64_t hash1, uint64_t hash2) {
-        uint64_t diff = hash1 ^ hash2;
-        size_t bits_changed = __builtin_popcountll(diff);
-        total_bit_changes_ += bits_changed;
-        total_tests_++;
+        count_difference((hash1 ^ hash2) & output_mask());
+    }
 
-        // Track which bits changed
-        for (size_t i = 0; i < output_bits_; ++i) {
-            if (diff & (1ULL << i)) {
-                bit_change_probabilities_[i]++;
+    /**
+     * @brief Analyze all single-bit flips of one key
+     * @param hash Hash of the key
+     * @param flipped flipped[i] is the hash of the key with input bit i flipped
+     * (bit i % 8 of byte i / 8)
+     * @param count Number of flipped hashes, normally 8 * key length
+     */
+    void add_flips(uint64_t hash, const uint64_t* flipped, size_t count) {
+        uint64_t mask = output_mask();
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t diff = (hash ^ flipped[i]) & mask;
+            count_difference(diff);
+            if (matrix_input_bits_ > 0) {
+                count_matrix(i, diff);
             }
         }
     }
 
+    /**
+     * @brief Add the samples of another analyzer
+     * @param other Analyzer over the same number of output and matrix input bits
+     */
+    void merge(const AvalancheAnalyzer& other) {
+        if (other.output_bits_ != output_bits_ || other.matrix_input_bits_ != matrix_input_bits_) {
+            throw std::invalid_argument("Cannot merge avalanche analyzers over different output bits");
+        }
+        flush_planes();
+        AvalancheAnalyzer copy = other;
+        copy.flush_planes();
+        total_tests_ += copy.total_tests_;
+        total_bit_changes_ += copy.total_bit_changes_;
+        for (size_t i = 0; i < output_bits_; ++i) {
+            bit_change_counts_[i] += copy.bit_change_counts_[i];
+        }
+        for (size_t i = 0; i < sac_counts_.size(); ++i) sac_counts_[i] += copy.sac_counts_[i];
+        for (size_t i = 0; i < sac_samples_.size(); ++i) sac_samples_[i] += copy.sac_samples_[i];
+        for (size_t i = 0; i < pair_counts_.size(); ++i) pair_counts_[i] += copy.pair_counts_[i];
+    }
+
     /**
      * @brief Get the average avalanche score
      * @return Score between 0 and 1 (0.5 is ideal)
@@ -75,9 +184,14 @@ public:
      * @return Vector of probabilities for each bit position
      */
     std::vector<double> get_bit_probabilities() const {
-        if (total_tests_ == 0) return bit_change_probabilities_;
+        std::vector<double> probs(bit_change_counts_.begin(), bit_change_counts_.end());
+        for (size_t p = 0; p < PLANES; ++p) {
+            for (size_t j = 0; j < output_bits_; ++j) {
+                if (planes_[p] >> j & 1) probs[j] += static_cast<double>(size_t{1} << p);
+            }
+        }
+        if (total_tests_ == 0) return probs;
         
-        std::vector<double> probs = bit_change_probabilities_;
         for (auto& p : probs) {
             p /= total_tests_;
         }
@@ -99,6 +213,73 @@ public:
         
         return std::sqrt(sum_squared_deviation / output_bits_);
     }
+
+    /**
+     * @brief Whether the SAC/BIC matrices are collected
+     */
+    bool has_matrix() const { return matrix_input_bits_ > 0; }
+
+    /**
+     * @brief Strict avalanche criterion matrix
+     * @return Row-major [input bit][output bit] probability that the output bit
+     * changes when the input bit is flipped (0.5 is ideal); rows without samples are 0
+     */
+    std::vector<double> get_sac_matrix() const {
+        std::vector<double> matrix(sac_counts_.size(), 0.0);
+        for (size_t i = 0; i < matrix_input_bits_; ++i) {
+            if (sac_samples_[i] == 0) continue;
+            for (size_t j = 0; j < output_bits_; ++j) {
+                matrix[i * output_bits_ + j] = static_cast<double>(sac_counts_[i * output_bits_ + j]) / sac_samples_[i];
+            }
+        }
+        return matrix;
+    }
+
+    /**
+     * @brief RMS deviation of the SAC matrix from 0.5 over the sampled input bits
+     * @return Bias value (0 is perfect, higher is worse)
+     */
+    double get_sac_bias() const {
+        std::vector<double> matrix = get_sac_matrix();
+        double sum_squared_deviation = 0.0;
+        size_t cells = 0;
+        for (size_t i = 0; i < matrix_input_bits_; ++i) {
+            if (sac_samples_[i] == 0) continue;
+            for (size_t j = 0; j < output_bits_; ++j) {
+                double deviation = matrix[i * output_bits_ + j] - 0.5;
+                sum_squared_deviation += deviation * deviation;
+                cells++;
+            }
+        }
+        return cells == 0 ? 0.0 : std::sqrt(sum_squared_deviation / cells);
+    }
+
+    /**
+     * @brief Bit independence criterion: largest correlation between the changes of two output bits
+     * @return Maximum absolute phi coefficient over all output bit pairs (0 is ideal)
+     */
+    double get_bic_max_correlation() const {
+        if (matrix_input_bits_ == 0) return 0.0;
+        double n = 0.0;
+        std::vector<double> changes(output_bits_, 0.0);
+        for (size_t i = 0; i < matrix_input_bits_; ++i) {
+            n += static_cast<double>(sac_samples_[i]);
+            for (size_t j = 0; j < output_bits_; ++j) {
+                changes[j] += static_cast<double>(sac_counts_[i * output_bits_ + j]);
+            }
+        }
+        double max_correlation = 0.0;
+        for (size_t j = 0; j < output_bits_; ++j) {
+            for (size_t k = j + 1; k < output_bits_; ++k) {
+                double both = static_cast<double>(pair_counts_[j * output_bits_ + k]);
+                double denominator = std::sqrt(changes[j] * (n - changes[j]) * changes[k] * (n - changes[k]));
+                if (denominator == 0.0) continue;
+                double correlation = (n * both - changes[j] * changes[k]) / denominator;
+                max_correlation = std::max(max_correlation, std::abs(correlation));
+            }
+        }
+        return max_correlation;
+    }
 };
 
 /**
@@ -132,6 +313,20 @@ public:
         total_samples_++;
     }
 
+    /**
+     * @brief Add the samples of another calculator
+     * @param other Calculator over the same number of buckets
+     */
+    void merge(const ChiSquaredCalculator& other) {
+        if (other.num_buckets_ != num_buckets_) {
+            throw std::invalid_argument("Cannot merge chi-squared calculators over different bucket counts");
+        }
+        for (size_t i = 0; i < num_buckets_; ++i) {
+            bucket_counts_[i] += other.bucket_counts_[i];
+        }
+        total_samples_ += other.total_samples_;
+    }
+
     /**
      * @brief Calculate chi-squared statistic
      * @return Chi-squared value (lower is better, 1.0 is ideal for large samples)
@@ -184,19 +379,164 @@ public:
     }
 };
 
+/**
+ * @brief Open-addressing table from hash value to the index of its first input
+ *
+ * 16 bytes per slot, linear probing, grown at 3/4 load. This is all that
+ * collision counting needs: whether a value was seen, and by which input, so
+ * the partner of a new collision is found without rescanning the inputs.
+ */
+class FirstIndexTable {
+public:
+    static constexpr uint64_t NONE = UINT64_MAX;
+
+private:
+    struct Slot {
+        uint64_t hash;
+        uint64_t first_index;  // NONE marks an empty slot
+    };
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+    unsigned shift_;
+
+    size_t home_of(uint64_t hash) const {
+        // A multiplier other than the partitioning one, whose top bits are constant here
+        return static_cast<size_t>((hash * 0xD6E8FEB86659FD93ULL) >> shift_);
+    }
+
+    void grow() {
+        std::vector<Slot> old = std::move(slots_);
+        slots_.assign(old.size() * 2, Slot{0, NONE});
+        shift_--;
+        size_t mask = slots_.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.first_index == NONE) continue;
+            size_t i = home_of(slot.hash);
+            while (slots_[i].first_index != NONE) i = (i + 1) & mask;
+            slots_[i] = slot;
+        }
+    }
+
+public:
+    FirstIndexTable() : slots_(16, Slot{0, NONE}), shift_(64 - 4) {}
+
+    /**
+     * @brief Record a value unless it is already present
+     * @param hash Hash value
+     * @param index Input index stored if the value is new (must not be NONE)
+     * @return Index stored for an earlier occurrence, or NONE if the value is new
+     */
+    uint64_t insert(uint64_t hash, uint64_t index) {
+        if ((size_ + 1) * 4 > slots_.size() * 3) grow();
+        size_t mask = slots_.size() - 1;
+        for (size_t i = home_of(hash);; i = (i + 1) & mask) {
+            Slot& slot = slots_[i];
+            if (slot.first_index == NONE) {
+                slot = Slot{hash, index};
+                size_++;
+                return NONE;
+            }
+            if (slot.hash == hash) return slot.first_index;
+        }
+    }
+
+    /**
+     * @brief Number of distinct values
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * @brief Call f(hash, first_index) for every value
+     */
+    template <typename F>
+    void for_each(F&& f) const {
+        for (const Slot& slot : slots_) {
+            if (slot.first_index != NONE) f(slot.hash, slot.first_index);
+        }
+    }
+};
+
+/**
+ * @brief One bit per hash value of a table-sized hash space, shared between threads
+ *
+ * Costs table_size / 8 bytes however many keys are hashed, against about
+ * 21 bytes per distinct value for a FirstIndexTable, and needs no merge: every
+ * analyzer of a run sets bits in the same set, and each collision is seen by
+ * exactly one of them.
+ */
+class DenseHashSet {
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+    uint64_t hash_space_size_;
+
+public:
+    /**
+     * @param hash_space_size Number of possible values; values are in [0, hash_space_size)
+     */
+    explicit DenseHashSet(uint64_t hash_space_size)
+        : words_(std::make_unique<std::atomic<uint64_t>[]>(hash_space_size / 64 + 1)),
+          hash_space_size_(hash_space_size) {}
+
+    /**
+     * @brief Mark a value as seen
+     * @return Whether it had been seen before
+     * @throws std::out_of_range if the value is outside the hash space
+     */
+    bool test_and_set(uint64_t hash_value) {
+        if (hash_value >= hash_space_size_) {
+            throw std::out_of_range("Hash value outside the dense hash space");
+        }
+        std::atomic<uint64_t>& word = words_[hash_value / 64];
+        uint64_t bit = 1ULL << (hash_value % 64);
+        // Skip the read-modify-write for values that are already set
+        if (word.load(std::memory_order_relaxed) & bit) return true;
+        return word.fetch_or(bit, std::memory_order_relaxed) & bit;
+    }
+
+    uint64_t hash_space_size() const { return hash_space_size_; }
+
+    /**
+     * @brief Bytes held by the bitmap
+     */
+    uint64_t memory_usage() const { return (hash_space_size_ / 64 + 1) * sizeof(uint64_t); }
+};
+
 /**
  * @brief Analyzes hash collisions and compares to birthday paradox predictions
  * 
  * Tracks actual collisions and compares to theoretical expectations based
- * on the birthday paradox for hash functions.
+ * on the birthday paradox for hash functions. The hash counts are split into
+ * PARTITIONS maps by hash value, so that analyzers of different key partitions
+ * can be merged one hash partition at a time, on several threads at once.
+ *
+ * Given a DenseHashSet the analyzer only counts, with one bit per table slot,
+ * and cannot name collision partners.
  */
 class CollisionAnalyzer {
+public:
+    static constexpr size_t PARTITIONS = 64;
+    static constexpr size_t MAX_COLLISION_DETAILS = 100;
+    static constexpr uint64_t NO_PARTNER = FirstIndexTable::NONE;
+    static constexpr uint64_t UNKNOWN_PARTNER = FirstIndexTable::NONE - 1;
+
 private:
-    std::unordered_map<uint64_t, size_t> hash_counts_;
+    std::vector<FirstIndexTable> first_indices_;
+    std::shared_ptr<DenseHashSet> dense_;
     size_t total_hashes_ = 0;
     size_t actual_collisions_ = 0;
     uint64_t hash_space_size_;
     std::vector<std::pair<uint64_t, std::vector<size_t>>> collision_details_;
+    std::unordered_map<uint64_t, size_t> detail_slots_;  // Hash value -> entry of collision_details_
+
+    void add_detail(uint64_t hash_value, const std::vector<size_t>& indices) {
+        auto [it, inserted] = detail_slots_.try_emplace(hash_value, collision_details_.size());
+        if (inserted) {
+            collision_details_.push_back({hash_value, indices});
+        } else {
+            auto& known = collision_details_[it->second].second;
+            known.insert(known.end(), indices.begin(), indices.end());
+        }
+    }
 
 public:
     /**
@@ -204,32 +544,102 @@ public:
      * @param hash_space_size Size of the hash space (e.g., table_size for modulo hashes)
      */
     explicit CollisionAnalyzer(uint64_t hash_space_size) 
-        : hash_space_size_(hash_space_size) {}
+        : first_indices_(PARTITIONS), hash_space_size_(hash_space_size) {}
+
+    /**
+     * @brief Constructor for a counting-only analyzer over a shared bitmap
+     * @param dense Set of seen values, shared by all analyzers of the run
+     */
+    explicit CollisionAnalyzer(std::shared_ptr<DenseHashSet> dense)
+        : dense_(std::move(dense)), hash_space_size_(dense_->hash_space_size()) {}
+
+    /**
+     * @brief Partition that counts a hash value
+     */
+    static size_t partition_of(uint64_t hash_value) {
+        // Hashes reduced to a table size have empty top bits, so mix before taking them
+        return static_cast<size_t>((hash_value * 0x9E3779B97F4A7C15ULL) >> 58);
+    }
 
     /**
      * @brief Add a hash value and check for collisions
      * @param hash_value Hash value to add
      * @param input_index Index of the input that produced this hash
+     * @return Index of the first input with the same hash, NO_PARTNER if the value
+     * is new, or UNKNOWN_PARTNER for a collision in a dense analyzer
      */
-    void add_hash(uint64_t hash_value, size_t input_index = 0) {
-        auto& count = hash_counts_[hash_value];
-        if (count > 0) {
+    uint64_t add_hash(uint64_t hash_value, size_t input_index = 0) {
+        uint64_t partner;
+        if (dense_) {
+            partner = dense_->test_and_set(hash_value) ? UNKNOWN_PARTNER : NO_PARTNER;
+        } else {
+            partner = first_indices_[partition_of(hash_value)].insert(hash_value, input_index);
+        }
+        if (partner != NO_PARTNER) {
             actual_collisions_++;
             
             // Track collision details for first few collisions
-            if (collision_details_.size() < 100) {
-                auto it = std::find_if(collision_details_.begin(), collision_details_.end(),
-                    [hash_value](const auto& p) { return p.first == hash_value; });
-                
-                if (it != collision_details_.end()) {
-                    it->second.push_back(input_index);
-                } else {
-                    collision_details_.push_back({hash_value, {input_index}});
-                }
+            if (collision_details_.size() < MAX_COLLISION_DETAILS) {
+                add_detail(hash_value, {input_index});
             }
         }
-        count++;
         total_hashes_++;
+        return partner;
+    }
+
+    /**
+     * @brief Add the counts of one hash partition of another analyzer
+     * @details Calls for different partitions may run concurrently. Once every
+     * partition has been merged, finish_merge() must be called with the same
+     * analyzer to update the totals.
+     * @param other Analyzer over another partition of the keys
+     * @param partition Hash partition in [0, PARTITIONS)
+     */
+    void merge_partition(const CollisionAnalyzer& other, size_t partition) {
+        if (dense_ || other.dense_) {
+            if (dense_ != other.dense_) {
+                throw std::invalid_argument("Dense collision analyzers merge only with analyzers over the same set");
+            }
+            return;  // Both already counted into the shared set
+        }
+        FirstIndexTable& table = first_indices_[partition];
+        // Indices of the other analyzer refer to its own inputs; an existing first index is kept
+        other.first_indices_[partition].for_each([&](uint64_t hash_value, uint64_t first_index) {
+            table.insert(hash_value, first_index);
+        });
+    }
+
+    /**
+     * @brief Update the totals after merge_partition() has run for every partition of other
+     * @param other The analyzer that was merged
+     */
+    void finish_merge(const CollisionAnalyzer& other) {
+        total_hashes_ += other.total_hashes_;
+        if (dense_) {
+            // The shared set already counted each collision in exactly one analyzer
+            actual_collisions_ += other.actual_collisions_;
+        } else {
+            // A collision is a hash landing on an occupied value, including values seen by the other analyzer
+            actual_collisions_ = total_hashes_ - get_unique_hashes();
+        }
+        for (const auto& [hash_value, indices] : other.collision_details_) {
+            if (collision_details_.size() >= MAX_COLLISION_DETAILS) break;
+            add_detail(hash_value, indices);
+        }
+    }
+
+    /**
+     * @brief Add all counts of another analyzer
+     * @param other Analyzer over another partition of the keys
+     */
+    void merge(const CollisionAnalyzer& other) {
+        if (other.hash_space_size_ != hash_space_size_) {
+            throw std::invalid_argument("Cannot merge collision analyzers over different hash spaces");
+        }
+        for (size_t partition = 0; partition < PARTITIONS; ++partition) {
+            merge_partition(other, partition);
+        }
+        finish_merge(other);
     }
 
     /**
@@ -272,12 +682,24 @@ public:
         return actual_collisions_ / expected;
     }
 
+    /**
+     * @brief Get number of hashes added, including merged ones
+     */
+    size_t get_total_hashes() const {
+        return total_hashes_;
+    }
+
     /**
      * @brief Get number of unique hash values
      * @return Count of unique hashes
      */
     size_t get_unique_hashes() const {
-        return hash_counts_.size();
+        if (dense_) return total_hashes_ - actual_collisions_;
+        size_t unique = 0;
+        for (const auto& table : first_indices_) {
+            unique += table.size();
+        }
+        return unique;
     }
 
     /**
@@ -301,7 +723,7 @@ public:
      * @return Load factor between 0 and 1
      */
     double get_load_factor() const {
-        return static_cast<double>(hash_counts_.size()) / hash_space_size_;
+        return static_cast<double>(get_unique_hashes()) / hash_space_size_;
     }
 };
 
@@ -0,0 +1,275 @@
+#pragma once
+
+#include "test_data.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace goldenhash::tests {
+
+/**
+ * @brief Test data in a memory-mapped binary corpus file
+ *
+ * The corpus is an append-only file of length-prefixed records behind a small
+ * header, plus an index file (`<path>.idx`) with the file offset of every
+ * record. Keys are buffered and appended while the corpus is written; the
+ * first read maps both files with MADV_SEQUENTIAL, after which get_view()
+ * returns spans straight into the page cache without any locking.
+ *
+ * A completed corpus stays on disk and is reopened by later runs with the same
+ * path, so it is generated once and shared by every algorithm and run.
+ * Keys cannot be added once the corpus has been read.
+ */
+class MmapTestData : public TestData {
+private:
+    struct FileHeader {
+        char magic[8];
+        uint64_t version;
+        uint64_t count;       // Number of records; 0 until the corpus is complete
+        uint64_t data_bytes;  // Bytes of records after the header
+    };
+    static constexpr char MAGIC[8] = {'G', 'H', 'C', 'O', 'R', 'P', 'U', 'S'};
+    static constexpr uint64_t VERSION = 1;
+    static constexpr size_t WRITE_BUFFER_SIZE = 1 << 20;
+
+    std::string path_;
+    std::string index_path_;
+    int data_fd_ = -1;
+    int index_fd_ = -1;
+    std::mutex mutex_;
+
+    // Write side
+    std::vector<uint8_t> data_buffer_;
+    std::vector<uint64_t> index_buffer_;
+    uint64_t count_ = 0;
+    uint64_t data_bytes_ = 0;
+
+    // Read side
+    std::atomic<bool> mapped_{false};
+    const uint8_t* data_map_ = nullptr;
+    const uint64_t* index_map_ = nullptr;
+    size_t data_map_size_ = 0;
+    size_t index_map_size_ = 0;
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error(what + " " + path_ + ": " + std::strerror(errno));
+    }
+
+    static void write_all(int fd, const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        while (size > 0) {
+            ssize_t written = ::write(fd, bytes, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(std::string("Failed to write test corpus: ") + std::strerror(errno));
+            }
+            bytes += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+    void write_header(uint64_t count) {
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.count = count;
+        header.data_bytes = data_bytes_;
+        if (::pwrite(data_fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+            fail("Failed to write test corpus header");
+        }
+    }
+
+    /**
+     * @brief Reopen a complete corpus, or start a new one if the files are missing or incomplete
+     */
+    void open_files() {
+        data_fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT, 0644);
+        if (data_fd_ < 0) fail("Failed to open test corpus");
+        index_fd_ = ::open(index_path_.c_str(), O_RDWR | O_CREAT, 0644);
+        if (index_fd_ < 0) fail("Failed to open test corpus index");
+
+        FileHeader header{};
+        struct stat data_stat{}, index_stat{};
+        bool complete = ::pread(data_fd_, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header))
+            && std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+            && header.version == VERSION
+            && header.count > 0
+            && ::fstat(data_fd_, &data_stat) == 0
+            && ::fstat(index_fd_, &index_stat) == 0
+            && static_cast<uint64_t>(data_stat.st_size) == sizeof(FileHeader) + header.data_bytes
+            && static_cast<uint64_t>(index_stat.st_size) == header.count * sizeof(uint64_t);
+        if (complete) {
+            count_ = header.count;
+            data_bytes_ = header.data_bytes;
+            map_files();
+        } else {
+            reset_files();
+        }
+    }
+
+    void reset_files() {
+        if (::ftruncate(data_fd_, 0) != 0 || ::ftruncate(index_fd_, 0) != 0) {
+            fail("Failed to truncate test corpus");
+        }
+        count_ = 0;
+        data_bytes_ = 0;
+        // A zero count marks the corpus as incomplete until seal()
+        write_header(0);
+        ::lseek(data_fd_, sizeof(FileHeader), SEEK_SET);
+        ::lseek(index_fd_, 0, SEEK_SET);
+    }
+
+    void flush_buffers() {
+        if (!data_buffer_.empty()) {
+            write_all(data_fd_, data_buffer_.data(), data_buffer_.size());
+            data_buffer_.clear();
+        }
+        if (!index_buffer_.empty()) {
+            write_all(index_fd_, index_buffer_.data(), index_buffer_.size() * sizeof(uint64_t));
+            index_buffer_.clear();
+        }
+    }
+
+    void append(const uint8_t* test, size_t len) {
+        if (mapped_.load(std::memory_order_relaxed)) {
+            throw std::logic_error("Cannot add tests to a memory-mapped corpus after it has been read");
+        }
+        if (len > UINT32_MAX) {
+            throw std::length_error("Test key too large for the corpus format");
+        }
+        uint32_t prefix = static_cast<uint32_t>(len);
+        index_buffer_.push_back(sizeof(FileHeader) + data_bytes_);
+        const uint8_t* prefix_bytes = reinterpret_cast<const uint8_t*>(&prefix);
+        data_buffer_.insert(data_buffer_.end(), prefix_bytes, prefix_bytes + sizeof(prefix));
+        data_buffer_.insert(data_buffer_.end(), test, test + len);
+        data_bytes_ += sizeof(prefix) + len;
+        count_++;
+        if (data_buffer_.size() >= WRITE_BUFFER_SIZE) {
+            flush_buffers();
+        }
+    }
+
+    void map_files() {
+        if (count_ > 0) {
+            data_map_size_ = sizeof(FileHeader) + data_bytes_;
+            index_map_size_ = count_ * sizeof(uint64_t);
+            void* data = ::mmap(nullptr, data_map_size_, PROT_READ, MAP_SHARED, data_fd_, 0);
+            if (data == MAP_FAILED) fail("Failed to map test corpus");
+            void* index = ::mmap(nullptr, index_map_size_, PROT_READ, MAP_SHARED, index_fd_, 0);
+            if (index == MAP_FAILED) {
+                ::munmap(data, data_map_size_);
+                fail("Failed to map test corpus index");
+            }
+            // Benchmarks walk the records in order
+            ::madvise(data, data_map_size_, MADV_SEQUENTIAL);
+            ::madvise(index, index_map_size_, MADV_SEQUENTIAL);
+            data_map_ = static_cast<const uint8_t*>(data);
+            index_map_ = static_cast<const uint64_t*>(index);
+        }
+        mapped_.store(true, std::memory_order_release);
+    }
+
+    void unmap_files() {
+        if (data_map_) ::munmap(const_cast<uint8_t*>(data_map_), data_map_size_);
+        if (index_map_) ::munmap(const_cast<uint64_t*>(index_map_), index_map_size_);
+        data_map_ = nullptr;
+        index_map_ = nullptr;
+        mapped_.store(false, std::memory_order_release);
+    }
+
+    /**
+     * @brief Write out pending records, mark the corpus complete and map it
+     */
+    void seal() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (mapped_.load(std::memory_order_acquire)) return;
+        flush_buffers();
+        write_header(count_);
+        map_files();
+    }
+
+public:
+    /**
+     * @brief Open or create a corpus
+     * @param path Path of the corpus file; the index is written to path + ".idx"
+     * @throws std::runtime_error if the files cannot be opened
+     */
+    explicit MmapTestData(const std::string& path) : path_(path), index_path_(path + ".idx") {
+        data_buffer_.reserve(WRITE_BUFFER_SIZE + 4096);
+        open_files();
+    }
+
+    ~MmapTestData() {
+        // Leave a complete corpus behind for the next run
+        if (!mapped_.load()) {
+            try {
+                flush_buffers();
+                write_header(count_);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+            }
+        }
+        unmap_files();
+        if (data_fd_ >= 0) ::close(data_fd_);
+        if (index_fd_ >= 0) ::close(index_fd_);
+    }
+
+    MmapTestData(const MmapTestData&) = delete;
+    MmapTestData& operator=(const MmapTestData&) = delete;
+
+    void add_test(const std::string& test) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        append(reinterpret_cast<const uint8_t*>(test.data()), test.size());
+    }
+
+    void add_batch(const TestBatch& batch) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < batch.size(); i++) {
+            std::span<const uint8_t> test = batch.view(i);
+            append(test.data(), test.size());
+        }
+    }
+
+    /**
+     * @brief Discard the corpus so that it can be written again
+     */
+    void clean_up() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        unmap_files();
+        data_buffer_.clear();
+        index_buffer_.clear();
+        reset_files();
+    }
+
+    std::string get_test(size_t index) override {
+        std::span<const uint8_t> test = get_view(index);
+        return std::string(test.begin(), test.end());
+    }
+
+    std::span<const uint8_t> get_view(size_t index) override {
+        if (!mapped_.load(std::memory_order_acquire)) {
+            seal();
+        }
+        if (index >= count_) {
+            throw std::out_of_range("Index out of range");
+        }
+        const uint8_t* record = data_map_ + index_map_[index];
+        uint32_t len;
+        std::memcpy(&len, record, sizeof(len));
+        return {record + sizeof(len), len};
+    }
+
+    size_t size() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return count_;
+    }
+};
+
+} // namespace goldenhash::tests
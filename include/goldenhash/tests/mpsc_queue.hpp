@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace goldenhash::tests {
+
+/**
+ * @brief Bounded lock-free multi-producer single-consumer ring buffer
+ *
+ * Every slot carries a sequence number that says whose turn it is: a producer
+ * claims a slot by advancing the shared tail with a CAS, fills it and then
+ * publishes it by bumping the slot's sequence, so producers never wait on
+ * each other's copies. The single consumer owns the head and needs no atomic
+ * read-modify-write at all.
+ */
+template <typename T>
+class MpscQueue {
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> tail_{0};  // Next slot to claim, shared by the producers
+    alignas(64) size_t head_ = 0;              // Next slot to read, owned by the consumer
+
+public:
+    /**
+     * @param capacity Number of slots, rounded up to a power of two
+     */
+    explicit MpscQueue(size_t capacity) {
+        size_t size = std::bit_ceil(std::max<size_t>(capacity, 2));
+        slots_ = std::make_unique<Slot[]>(size);
+        mask_ = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * @brief Append an item; safe to call from any number of threads
+     * @param item Moved from only when the push succeeds
+     * @return false if the queue is full
+     */
+    bool try_push(T&& item) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[pos & mask_];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            auto lag = static_cast<std::intptr_t>(sequence - pos);
+            if (lag == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.item = std::move(item);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;  // The consumer has not freed this slot yet
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Remove the oldest published item; consumer side only
+     * @return false if the queue is empty
+     */
+    bool try_pop(T& item) {
+        Slot& slot = slots_[head_ & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != head_ + 1) return false;
+        item = std::move(slot.item);
+        // The slot comes round again one lap later
+        slot.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+        head_++;
+        return true;
+    }
+};
+
+} // namespace goldenhash::tests
@@ -0,0 +1,181 @@
+/**
+ * @file perf_counters.hpp
+ * @brief Hardware performance counters around a measured region
+ * @author Josh Morgan
+ * @date 2025
+ *
+ * Reads cycles, instructions, L1D read misses and branch misses of the
+ * calling thread through perf_event_open(2). The counters tell whether the
+ * hash loop is bound by S-box misses in L1D, by the multiply chain (low IPC
+ * with few misses) or by mispredicted tails.
+ */
+
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace goldenhash::tests {
+
+/**
+ * @brief Counter values of one measured region
+ */
+struct PerfSample {
+    enum Counter : size_t { CYCLES, INSTRUCTIONS, L1D_MISSES, BRANCH_MISSES, NUM_COUNTERS };
+
+    static constexpr std::array<const char*, NUM_COUNTERS> NAMES = {
+        "cycles", "instructions", "l1d_misses", "branch_misses"
+    };
+
+    std::array<uint64_t, NUM_COUNTERS> values{};
+    std::array<bool, NUM_COUNTERS> present{};  // Whether the CPU provided the counter
+    uint64_t hashes = 0;                       // Hashes computed in the region
+
+    /**
+     * @brief Instructions per cycle, 0 if either counter is missing
+     */
+    double ipc() const {
+        if (!present[CYCLES] || !present[INSTRUCTIONS] || values[CYCLES] == 0) return 0.0;
+        return static_cast<double>(values[INSTRUCTIONS]) / values[CYCLES];
+    }
+
+    /**
+     * @brief Counter value per hash, 0 if the counter is missing
+     */
+    double per_hash(Counter counter) const {
+        if (!present[counter] || hashes == 0) return 0.0;
+        return static_cast<double>(values[counter]) / hashes;
+    }
+
+    /**
+     * @brief Add the counts of a region measured alongside this one, e.g. on another thread
+     * @details A counter stays present only if both samples have it.
+     */
+    void merge(const PerfSample& other) {
+        for (size_t i = 0; i < NUM_COUNTERS; ++i) {
+            values[i] += other.values[i];
+            present[i] = present[i] && other.present[i];
+        }
+        hashes += other.hashes;
+    }
+};
+
+/**
+ * @class PerfCounters
+ * @brief A perf_event group counting the calling thread in user space
+ *
+ * Cycles lead the group, so all counters run over exactly the same
+ * interval; counters the CPU does not offer (common in virtual machines)
+ * are left out of the group and reported as missing. An instance counts the
+ * thread that created it and must be started and stopped on that thread.
+ */
+class PerfCounters {
+public:
+    /**
+     * @brief Open the counters
+     * @throws std::runtime_error if perf_event_open() is unavailable or refuses the cycles counter
+     */
+    PerfCounters() {
+#ifdef __linux__
+        open_counter(PerfSample::CYCLES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        if (fds_.empty()) {
+            throw std::runtime_error(std::string("perf_event_open for cycles failed: ") + std::strerror(errno) +
+                                     " (see /proc/sys/kernel/perf_event_paranoid)");
+        }
+        open_counter(PerfSample::INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        open_counter(PerfSample::L1D_MISSES, PERF_TYPE_HW_CACHE,
+                     PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+        open_counter(PerfSample::BRANCH_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#else
+        throw std::runtime_error("Hardware counters need Linux perf_event_open()");
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            close(fd);
+        }
+#endif
+    }
+
+    /**
+     * @brief Reset the counters to zero and start counting
+     */
+    void start() {
+#ifdef __linux__
+        ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    /**
+     * @brief Stop counting and read the counters
+     * @details Counts are scaled up if the kernel had to multiplex the group
+     * with other events for part of the region.
+     * @param hashes Number of hashes computed since start()
+     * @throws std::runtime_error if the counters cannot be read
+     */
+    PerfSample stop(uint64_t hashes) {
+        PerfSample sample;
+        sample.hashes = hashes;
+#ifdef __linux__
+        ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        // nr, time_enabled, time_running, then one value per counter in the order opened
+        std::vector<uint64_t> buffer(3 + counters_.size());
+        ssize_t expected = static_cast<ssize_t>(buffer.size() * sizeof(uint64_t));
+        if (read(fds_[0], buffer.data(), expected) != expected) {
+            throw std::runtime_error(std::string("Failed to read perf counters: ") + std::strerror(errno));
+        }
+        uint64_t enabled = buffer[1];
+        uint64_t running = buffer[2];
+        double scale = (running > 0 && running < enabled) ? static_cast<double>(enabled) / running : 1.0;
+        for (size_t i = 0; i < counters_.size() && i < buffer[0]; ++i) {
+            sample.values[counters_[i]] = static_cast<uint64_t>(buffer[3 + i] * scale);
+            sample.present[counters_[i]] = running > 0;
+        }
+#endif
+        return sample;
+    }
+
+private:
+#ifdef __linux__
+    void open_counter(PerfSample::Counter counter, uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = fds_.empty() ? 1 : 0;  // Members follow the leader
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int group = fds_.empty() ? -1 : fds_[0];
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+        if (fd < 0) return;
+        fds_.push_back(fd);
+        counters_.push_back(counter);
+    }
+#endif
+
+    std::vector<int> fds_;
+    std::vector<PerfSample::Counter> counters_;
+};
+
+} // namespace goldenhash::tests
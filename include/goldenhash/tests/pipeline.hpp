@@ -0,0 +1,247 @@
+#pragma once
+
+#include "common.hpp"
+#include "spsc_queue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace goldenhash::tests {
+
+/**
+ * @brief Median and tail latency of one pipeline stage
+ */
+struct StageLatency {
+    double p50_ns = 0.0;
+    double p99_ns = 0.0;
+    size_t samples = 0;
+};
+
+/**
+ * @brief Result of an end-to-end pipeline benchmark
+ */
+struct PipelineResult {
+    size_t num_producers = 0;
+    size_t num_consumers = 0;
+    uint64_t total_hashes = 0;
+    uint64_t total_bytes = 0;
+    double elapsed_ms = 0.0;
+    double hashes_per_second = 0.0;
+    double ns_per_hash = 0.0;       // Wall time per hash across the whole pipeline
+    double throughput_mbs = 0.0;
+    StageLatency hash_stage;        // Hashing one key in a producer
+    StageLatency queue_stage;       // From enqueue until a consumer dequeues the hash
+    StageLatency insert_stage;      // process_hash() on the shard
+};
+
+/**
+ * @brief Multi-threaded hash → route → insert benchmark
+ *
+ * Each producer hashes its own TestData partition and routes every hash to one
+ * of the 64 shards by the top six bits of a Fibonacci mix of the hash (hashes
+ * already reduced to the table size have empty top bits). Every producer has
+ * one SPSC queue per consumer, and consumer c owns the shards with
+ * index % num_consumers == c, so a shard is only ever written by one thread.
+ *
+ * Every SAMPLE_INTERVAL-th key of a producer is timestamped on its way through
+ * the pipeline to give per-stage latency percentiles without timing every key.
+ */
+class PipelineBenchmark {
+public:
+    static constexpr size_t NUM_SHARDS = 64;
+    static constexpr size_t QUEUE_CAPACITY = 1024;
+    static constexpr size_t SAMPLE_INTERVAL = 64;
+    static constexpr size_t POP_BURST = 256;
+
+private:
+    struct Item {
+        uint64_t hash;
+        uint64_t enqueue_ns;  // 0 unless the item is a latency sample
+    };
+
+    struct ProducerStats {
+        uint64_t hashes = 0;
+        uint64_t bytes = 0;
+        std::vector<uint64_t> hash_ns;
+    };
+
+    struct ConsumerStats {
+        std::vector<uint64_t> queue_ns;
+        std::vector<uint64_t> insert_ns;
+    };
+
+    std::vector<MapShard*> shards_;
+    const GoldenHash& hasher_;
+    const HashAlgorithm& algorithm_;
+    uint64_t table_size_;
+    size_t num_consumers_;
+
+    static uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static size_t shard_of(uint64_t hash) {
+        return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ULL) >> 58);
+    }
+
+    static StageLatency percentiles(std::vector<uint64_t>& samples) {
+        StageLatency latency;
+        latency.samples = samples.size();
+        if (samples.empty()) return latency;
+        auto at = [&](double fraction) {
+            size_t rank = static_cast<size_t>(fraction * (samples.size() - 1));
+            std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+            return static_cast<double>(samples[rank]);
+        };
+        latency.p50_ns = at(0.50);
+        latency.p99_ns = at(0.99);
+        return latency;
+    }
+
+public:
+    /**
+     * @param shards Exactly 64 shards that receive the hashes
+     * @param hasher GoldenHash instance used when algorithm is "goldenhash"
+     * @param algorithm Name of a registered hash algorithm
+     * @param table_size Table size the hashes are reduced to
+     * @param num_consumers Number of insert threads (at least 1, at most 64)
+     */
+    PipelineBenchmark(std::vector<MapShard*> shards, const GoldenHash& hasher, std::string algorithm,
+                      uint64_t table_size, size_t num_consumers)
+        : shards_(std::move(shards)), hasher_(hasher), algorithm_(find_hash_algorithm(algorithm)),
+          table_size_(table_size), num_consumers_(num_consumers) {
+        if (shards_.size() != NUM_SHARDS) {
+            throw std::runtime_error("These tests require exactly 64 shards");
+        }
+        if (num_consumers_ == 0 || num_consumers_ > NUM_SHARDS) {
+            throw std::invalid_argument("Number of consumers must be between 1 and 64");
+        }
+    }
+
+    /**
+     * @brief Hash every key of every partition into the shards
+     * @param partitions One TestData partition per producer thread
+     * @return Aggregate throughput and per-stage latencies
+     */
+    PipelineResult run(std::span<TestData* const> partitions) {
+        size_t num_producers = partitions.size();
+        if (num_producers == 0) {
+            throw std::invalid_argument("The pipeline needs at least one producer");
+        }
+
+        // queues[p * num_consumers_ + c] carries hashes from producer p to consumer c
+        std::vector<std::unique_ptr<SpscQueue<Item>>> queues;
+        queues.reserve(num_producers * num_consumers_);
+        for (size_t i = 0; i < num_producers * num_consumers_; ++i) {
+            queues.push_back(std::make_unique<SpscQueue<Item>>(QUEUE_CAPACITY));
+        }
+        std::vector<ProducerStats> producer_stats(num_producers);
+        std::vector<ConsumerStats> consumer_stats(num_consumers_);
+        std::atomic<size_t> producers_done{0};
+
+        auto producer = [&](size_t p) {
+            TestData* data = partitions[p];
+            ProducerStats& stats = producer_stats[p];
+            size_t num_tests = data->size();
+            stats.hash_ns.reserve(num_tests / SAMPLE_INTERVAL + 1);
+            HashFunction hash_function = algorithm_.make(table_size_, hasher_);
+            std::visit([&](auto& hash_fn) {
+                for (size_t i = 0; i < num_tests; ++i) {
+                    std::span<const uint8_t> test = data->get_view(i);
+                    Item item{0, 0};
+                    if (i % SAMPLE_INTERVAL == 0) {
+                        uint64_t start = now_ns();
+                        item.hash = hash_fn(test.data(), test.size());
+                        item.enqueue_ns = now_ns();
+                        stats.hash_ns.push_back(item.enqueue_ns - start);
+                    } else {
+                        item.hash = hash_fn(test.data(), test.size());
+                    }
+                    stats.bytes += test.size();
+                    SpscQueue<Item>& queue = *queues[p * num_consumers_ + shard_of(item.hash) % num_consumers_];
+                    while (!queue.try_push(item)) {
+                        std::this_thread::yield();
+                    }
+                }
+            }, hash_function);
+            stats.hashes = num_tests;
+            producers_done.fetch_add(1, std::memory_order_release);
+        };
+
+        auto consumer = [&](size_t c) {
+            ConsumerStats& stats = consumer_stats[c];
+            Item item;
+            while (true) {
+                // Read the flag before draining so that a pass that finds nothing proves the queues are empty for good
+                bool finished = producers_done.load(std::memory_order_acquire) == num_producers;
+                size_t popped = 0;
+                for (size_t p = 0; p < num_producers; ++p) {
+                    SpscQueue<Item>& queue = *queues[p * num_consumers_ + c];
+                    for (size_t n = 0; n < POP_BURST && queue.try_pop(item); ++n) {
+                        MapShard* shard = shards_[shard_of(item.hash)];
+                        if (item.enqueue_ns != 0) {
+                            uint64_t dequeued = now_ns();
+                            shard->process_hash(item.hash);
+                            stats.queue_ns.push_back(dequeued - item.enqueue_ns);
+                            stats.insert_ns.push_back(now_ns() - dequeued);
+                        } else {
+                            shard->process_hash(item.hash);
+                        }
+                        popped++;
+                    }
+                }
+                if (popped == 0) {
+                    if (finished) break;
+                    std::this_thread::yield();
+                }
+            }
+        };
+
+        uint64_t start = now_ns();
+        std::vector<std::thread> threads;
+        threads.reserve(num_producers + num_consumers_);
+        for (size_t c = 0; c < num_consumers_; ++c) {
+            threads.emplace_back(consumer, c);
+        }
+        for (size_t p = 0; p < num_producers; ++p) {
+            threads.emplace_back(producer, p);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        uint64_t elapsed = now_ns() - start;
+
+        PipelineResult result;
+        result.num_producers = num_producers;
+        result.num_consumers = num_consumers_;
+        std::vector<uint64_t> hash_ns, queue_ns, insert_ns;
+        for (auto& stats : producer_stats) {
+            result.total_hashes += stats.hashes;
+            result.total_bytes += stats.bytes;
+            hash_ns.insert(hash_ns.end(), stats.hash_ns.begin(), stats.hash_ns.end());
+        }
+        for (auto& stats : consumer_stats) {
+            queue_ns.insert(queue_ns.end(), stats.queue_ns.begin(), stats.queue_ns.end());
+            insert_ns.insert(insert_ns.end(), stats.insert_ns.begin(), stats.insert_ns.end());
+        }
+        result.elapsed_ms = elapsed / 1e6;
+        if (elapsed > 0 && result.total_hashes > 0) {
+            result.hashes_per_second = result.total_hashes / (elapsed / 1e9);
+            result.ns_per_hash = static_cast<double>(elapsed) / result.total_hashes;
+            result.throughput_mbs = (result.total_bytes / (1024.0 * 1024.0)) / (elapsed / 1e9);
+        }
+        result.hash_stage = percentiles(hash_ns);
+        result.queue_stage = percentiles(queue_ns);
+        result.insert_stage = percentiles(insert_ns);
+        return result;
+    }
+};
+
+} // namespace goldenhash::tests
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+
+namespace goldenhash::tests {
+
+/**
+ * @brief Bounded lock-free single-producer single-consumer ring buffer
+ *
+ * Head and tail live on separate cache lines and each side keeps a cached
+ * copy of the other's index, so the shared lines are only touched when the
+ * cached view says the ring is full (or empty).
+ */
+template <typename T>
+class SpscQueue {
+private:
+    std::unique_ptr<T[]> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{0};  // Next slot to read, owned by the consumer
+    size_t cached_tail_ = 0;
+    alignas(64) std::atomic<size_t> tail_{0};  // Next slot to write, owned by the producer
+    size_t cached_head_ = 0;
+
+public:
+    /**
+     * @param capacity Number of slots, rounded up to a power of two
+     */
+    explicit SpscQueue(size_t capacity) {
+        size_t size = std::bit_ceil(std::max<size_t>(capacity, 2));
+        slots_ = std::make_unique<T[]>(size);
+        mask_ = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief Append an item; producer side only
+     * @return false if the queue is full
+     */
+    bool try_push(const T& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) return false;
+        }
+        slots_[tail & mask_] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest item; consumer side only
+     * @return false if the queue is empty
+     */
+    bool try_pop(T& item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) return false;
+        }
+        item = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+} // namespace goldenhash::tests
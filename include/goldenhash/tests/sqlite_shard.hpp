@@ -2,27 +2,84 @@
 
 #include "map_shard.hpp"
 #include <sqlite3.h>
+#include <algorithm>
 #include <atomic>
+#include <mutex>
+#include <vector>
 #include <thread>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
+#include <string>
 #include <cstdio>
 
 namespace goldenhash::tests {
 
 /**
  * @brief SQLite shard for handling a range of hash values
+ *
+ * Hashes are buffered and written in batches: a full buffer is sorted,
+ * collapsed into (hash, count) runs and upserted in one transaction, so each
+ * distinct hash of a batch costs one B-tree update and the data is committed
+ * every batch instead of once at the end. The table is keyed by the hash as a
+ * 64-bit INTEGER (the bit pattern of the unsigned value) WITHOUT ROWID.
  */
 class SQLiteShard : public MapShard {
 private:
     sqlite3* db;
-    sqlite3_stmt* insert_stmt;
-    sqlite3_stmt* select_stmt;
-    sqlite3_stmt* update_stmt;
-    std::atomic<bool> in_use{false};
-public:
+    sqlite3_stmt* upsert_stmt = nullptr;
+    sqlite3_stmt* select_stmt = nullptr;
+    std::mutex mutex_;
+    std::vector<uint64_t> buffer_;
+    size_t batch_size_;
+
+    /**
+     * @brief Roll the batch back, drop it and throw
+     * @param stage What failed, for the message
+     */
+    [[noreturn]] void fail_batch(const char* stage) {
+        std::string error = sqlite3_errmsg(db);
+        sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+        buffer_.clear();
+        throw std::runtime_error(std::string("Failed to write shard batch (") + stage + "): " + error);
+    }
+
+    /**
+     * @brief Write the buffered hashes in one transaction; mutex_ must be held
+     * @throws std::runtime_error if any step fails, including COMMIT; the batch is rolled back and dropped
+     */
+    void flush_locked() {
+        if (buffer_.empty()) return;
+        // Sorted keys turn the upserts into an in-order B-tree walk
+        std::sort(buffer_.begin(), buffer_.end());
+        if (sqlite3_exec(db, "BEGIN TRANSACTION", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            fail_batch("begin");
+        }
+        for (size_t i = 0; i < buffer_.size();) {
+            size_t run = i + 1;
+            while (run < buffer_.size() && buffer_[run] == buffer_[i]) run++;
+            sqlite3_bind_int64(upsert_stmt, 1, static_cast<int64_t>(buffer_[i]));
+            sqlite3_bind_int64(upsert_stmt, 2, static_cast<int64_t>(run - i));
+            int rc = sqlite3_step(upsert_stmt);
+            sqlite3_reset(upsert_stmt);
+            if (rc != SQLITE_DONE) {
+                fail_batch("upsert");
+            }
+            i = run;
+        }
+        if (sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            fail_batch("commit");
+        }
+        buffer_.clear();
+    }
 
-    SQLiteShard(std::string filename) {
+public:
+    /**
+     * @brief Open (or create) a shard database
+     * @param filename Database file, deleted again by the destructor
+     * @param batch_size Number of hashes buffered before they are written
+     */
+    SQLiteShard(std::string filename, size_t batch_size = 65536) : batch_size_(std::max<size_t>(batch_size, 1)) {
         
         // Open SQLite database
         if (sqlite3_open(filename.c_str(), &db) != SQLITE_OK) {
@@ -30,37 +87,47 @@ public:
         }
         
         // Create table if it doesn't exist
-        // Use BLOB for hash to handle full 64-bit unsigned range
-        const char* create_table = "CREATE TABLE IF NOT EXISTS hash_counts (hash BLOB PRIMARY KEY, count INTEGER)";
+        const char* create_table = "CREATE TABLE IF NOT EXISTS hash_counts (hash INTEGER PRIMARY KEY, count INTEGER NOT NULL) WITHOUT ROWID";
         if (sqlite3_exec(db, create_table, nullptr, nullptr, nullptr) != SQLITE_OK) {
+            std::string error = sqlite3_errmsg(db);
             sqlite3_close(db);
-            throw std::runtime_error("Failed to create table in shard: " + std::string(sqlite3_errmsg(db)));
+            throw std::runtime_error("Failed to create table in shard: " + error);
         }
         
         // Prepare statements
-        sqlite3_prepare_v2(db, "INSERT OR IGNORE INTO hash_counts (hash, count) VALUES (?, 1)", -1, &insert_stmt, nullptr);
-        sqlite3_prepare_v2(db, "SELECT count FROM hash_counts WHERE hash = ?", -1, &select_stmt, nullptr);
-        sqlite3_prepare_v2(db, "UPDATE hash_counts SET count = count + 1 WHERE hash = ?", -1, &update_stmt, nullptr);
+        if (sqlite3_prepare_v2(db, "INSERT INTO hash_counts (hash, count) VALUES (?, ?) "
+                                   "ON CONFLICT(hash) DO UPDATE SET count = count + excluded.count",
+                               -1, &upsert_stmt, nullptr) != SQLITE_OK ||
+            sqlite3_prepare_v2(db, "SELECT count FROM hash_counts WHERE hash = ?", -1, &select_stmt, nullptr) != SQLITE_OK) {
+            std::string error = sqlite3_errmsg(db);
+            sqlite3_finalize(upsert_stmt);
+            sqlite3_finalize(select_stmt);
+            sqlite3_close(db);
+            throw std::runtime_error("Failed to prepare shard statements: " + error);
+        }
         
         // SQLite special instructions for fast performance
         sqlite3_exec(db, "PRAGMA synchronous = OFF", nullptr, nullptr, nullptr);
         sqlite3_exec(db, "PRAGMA journal_mode = MEMORY", nullptr, nullptr, nullptr);
-        sqlite3_exec(db, "BEGIN TRANSACTION", nullptr, nullptr, nullptr);
+        buffer_.reserve(batch_size_);
     }
     
     ~SQLiteShard() {
         if (db) {
+            try {
+                std::lock_guard<std::mutex> lock(mutex_);
+                flush_locked();
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+            }
+
             // Get filename before closing
             const char* db_filename = sqlite3_db_filename(db, "main");
             std::string filename = db_filename ? db_filename : "";
             
-            // Commit any pending transaction
-            sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
-            
             // Finalize statements
-            sqlite3_finalize(insert_stmt);
+            sqlite3_finalize(upsert_stmt);
             sqlite3_finalize(select_stmt);
-            sqlite3_finalize(update_stmt);
             
             // Close database
             sqlite3_close(db);
@@ -81,27 +148,34 @@ public:
     SQLiteShard& operator=(SQLiteShard&&) = delete;
     
     void process_hash(uint64_t hash) override {
-        // Spinlock acquisition
-        bool expected = false;
-        while (!in_use.compare_exchange_weak(expected, true, 
-                                              std::memory_order_acquire,
-                                              std::memory_order_relaxed)) {
-            expected = false;
-            std::this_thread::yield();
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffer_.push_back(hash);
+        if (buffer_.size() >= batch_size_) {
+            flush_locked();
         }
-        // Try to insert or update
-        sqlite3_bind_blob(insert_stmt, 1, &hash, sizeof(hash), SQLITE_STATIC);
-        if (sqlite3_step(insert_stmt) != SQLITE_DONE) {
-            // Already exists, update count
-            sqlite3_reset(insert_stmt);
-            sqlite3_bind_blob(update_stmt, 1, &hash, sizeof(hash), SQLITE_STATIC);
-            sqlite3_step(update_stmt);
-            sqlite3_reset(update_stmt);
-        } else {
-            sqlite3_reset(insert_stmt);
+    }
+
+    /**
+     * @brief Write out the buffered hashes now
+     */
+    void flush() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flush_locked();
+    }
+
+    /**
+     * @brief Number of times a hash was processed, including buffered ones
+     */
+    uint64_t get_count(uint64_t hash) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flush_locked();
+        sqlite3_bind_int64(select_stmt, 1, static_cast<int64_t>(hash));
+        uint64_t count = 0;
+        if (sqlite3_step(select_stmt) == SQLITE_ROW) {
+            count = static_cast<uint64_t>(sqlite3_column_int64(select_stmt, 0));
         }
-        // Release spinlock
-        in_use.store(false, std::memory_order_release);
+        sqlite3_reset(select_stmt);
+        return count;
     }
 };
 
@@ -83,25 +83,16 @@ public:
     }
 
     std::string get_test(size_t index) override {
-        bool expected = false;
-        while (!in_use.compare_exchange_strong(expected, true,
-                std::memory_order_acquire, std::memory_order_relaxed)) {
-            expected = false;
-            std::this_thread::yield();
-        }
-        
-        sqlite3_bind_int(select_stmt, 1, static_cast<int>(index + 1)); // SQLite is 1-indexed
-        if (sqlite3_step(select_stmt) == SQLITE_ROW) {
-            const char* text = reinterpret_cast<const char*>(sqlite3_column_text(select_stmt, 0));
-            std::string result(text ? text : "");
-            sqlite3_reset(select_stmt);
-            in_use.store(false, std::memory_order_release);
-            return result;
-        } else {
-            sqlite3_reset(select_stmt);
-            in_use.store(false, std::memory_order_release);
-            throw std::out_of_range("Index out of range");
-        }
+        std::string result;
+        read_test(index, result);
+        return result;
+    }
+    
+    std::span<const uint8_t> get_view(size_t index) override {
+        // Rows only live as long as the statement, so the view is backed by a per-thread copy
+        static thread_local std::string buffer;
+        read_test(index, buffer);
+        return {reinterpret_cast<const uint8_t*>(buffer.data()), buffer.size()};
     }
     
     size_t size() override {
@@ -122,6 +113,31 @@ public:
         in_use.store(false, std::memory_order_release);
         return count;
     }
+
+private:
+    /**
+     * @brief Copy the test at index into out, reusing its capacity
+     */
+    void read_test(size_t index, std::string& out) {
+        bool expected = false;
+        while (!in_use.compare_exchange_strong(expected, true,
+                std::memory_order_acquire, std::memory_order_relaxed)) {
+            expected = false;
+            std::this_thread::yield();
+        }
+        
+        sqlite3_bind_int(select_stmt, 1, static_cast<int>(index + 1)); // SQLite is 1-indexed
+        if (sqlite3_step(select_stmt) == SQLITE_ROW) {
+            const char* text = reinterpret_cast<const char*>(sqlite3_column_text(select_stmt, 0));
+            out.assign(text ? text : "");
+            sqlite3_reset(select_stmt);
+            in_use.store(false, std::memory_order_release);
+        } else {
+            sqlite3_reset(select_stmt);
+            in_use.store(false, std::memory_order_release);
+            throw std::out_of_range("Index out of range");
+        }
+    }
 };
 
 } // namespace goldenhash
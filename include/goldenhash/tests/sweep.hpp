@@ -0,0 +1,570 @@
+/**
+ * @file sweep.hpp
+ * @brief In-process sweep of GoldenHash quality metrics over a range of table sizes
+ * @author Josh Morgan
+ * @date 2025
+ *
+ * Measures every N of a range inside one process. The test keys are generated
+ * once and shared. Workers hand finished results to a lock-free queue, and one
+ * writer thread stores them in batches, either as one JSON object per line,
+ * as rows of the modular_hash_results table used by
+ * python/collect_modular_data.py, or as fixed-width records of an append-only
+ * binary file that python/analyze_modular_results.py reads with numpy.
+ */
+
+#pragma once
+
+#include <goldenhash.hpp>
+#include <goldenhash/thread_pool.hpp>
+#include <goldenhash/tests/mpsc_queue.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#include <span>
+#include <sqlite3.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace goldenhash::tests {
+
+/**
+ * @brief Table sizes start, start + step, ... up to and including end
+ */
+struct SweepRange {
+    uint64_t start = 0;
+    uint64_t end = 0;
+    uint64_t step = 1;
+
+    /**
+     * @brief Parse "start:end" or "start:end:step"
+     * @param spec Range specification
+     * @return Parsed range
+     * @throws std::invalid_argument if the specification is malformed or starts below GoldenHash::MIN_TABLE_SIZE
+     */
+    static SweepRange parse(const std::string& spec) {
+        SweepRange range;
+        size_t first = spec.find(':');
+        if (first == std::string::npos) {
+            throw std::invalid_argument("Sweep range must be start:end[:step]: " + spec);
+        }
+        size_t second = spec.find(':', first + 1);
+        try {
+            range.start = std::stoull(spec.substr(0, first));
+            range.end = std::stoull(spec.substr(first + 1, second == std::string::npos ? std::string::npos : second - first - 1));
+            if (second != std::string::npos) {
+                range.step = std::stoull(spec.substr(second + 1));
+            }
+        } catch (const std::logic_error&) {
+            throw std::invalid_argument("Sweep range must be start:end[:step]: " + spec);
+        }
+        if (range.step == 0 || range.end < range.start) {
+            throw std::invalid_argument("Sweep range needs start <= end and a non-zero step: " + spec);
+        }
+        if (range.start < GoldenHash::MIN_TABLE_SIZE) {
+            throw std::invalid_argument("Sweep range must start at " + std::to_string(GoldenHash::MIN_TABLE_SIZE) +
+                                        " or above: " + spec);
+        }
+        return range;
+    }
+
+    /**
+     * @brief Number of table sizes in the range
+     */
+    uint64_t count() const { return (end - start) / step + 1; }
+
+    /**
+     * @brief The i-th table size of the range
+     */
+    uint64_t at(uint64_t i) const { return start + i * step; }
+};
+
+/**
+ * @brief Number of keys after which a table of size n expects a given number of collisions
+ * @details Same estimate as calculate_tests_for_collisions() in
+ * python/collect_modular_data.py, so sweeps reproduce its key counts.
+ * @param n Table size
+ * @param target_collisions Expected number of collisions
+ * @return Number of keys, at least 100
+ */
+inline uint64_t tests_for_collisions(uint64_t n, double target_collisions) {
+    if (target_collisions >= static_cast<double>(n)) {
+        return n;
+    }
+    // Birthday paradox: E[collisions] = t - n * (1 - e^(-t/n)), refined from t = sqrt(2 * n * k)
+    int64_t tests = static_cast<int64_t>(std::sqrt(2.0 * n * target_collisions));
+    for (int i = 0; i < 10; i++) {
+        double expected_unique = n * (1 - std::exp(-double(tests) / n));
+        double expected_collisions = tests - expected_unique;
+        if (expected_collisions < target_collisions * 0.9) {
+            tests = static_cast<int64_t>(tests * 1.1);
+        } else if (expected_collisions > target_collisions * 1.1) {
+            tests = static_cast<int64_t>(tests * 0.95);
+        } else {
+            break;
+        }
+    }
+    return std::max<int64_t>(tests, 100);
+}
+
+/**
+ * @brief Result for one table size of a sweep
+ */
+struct SweepResult {
+    CollectiveMetrics metrics;
+    uint64_t num_tests = 0;
+    bool is_prime = false;
+    uint64_t test_hash = 0;  // hash("abc"), a cheap fingerprint of the hasher
+};
+
+/**
+ * @brief Destination of sweep results
+ * @details Sinks are written by one thread at a time; run_sweep() funnels the
+ * workers' results through an AsyncSweepSink.
+ */
+class SweepSink {
+public:
+    virtual ~SweepSink() = default;
+
+    /**
+     * @brief Store one result
+     * @param result Completed result
+     */
+    virtual void write(const SweepResult& result) = 0;
+
+    /**
+     * @brief Store several results at once
+     * @details Sinks with a per-write cost, such as a transaction, override this
+     * to pay it once per batch.
+     * @param results Completed results
+     */
+    virtual void write_batch(std::span<const SweepResult> results) {
+        for (const SweepResult& result : results) {
+            write(result);
+        }
+    }
+};
+
+/**
+ * @brief Writes each result as one JSON object per line and flushes it
+ */
+class JsonLinesSweepSink : public SweepSink {
+private:
+    std::ostream& out_;
+
+public:
+    explicit JsonLinesSweepSink(std::ostream& out) : out_(out) {}
+
+    void write(const SweepResult& result) override {
+        const CollectiveMetrics& m = result.metrics;
+        std::ostringstream ss;
+        ss << std::setprecision(17);
+        ss << "{\"table_size\": " << m.table_size
+           << ", \"is_prime\": " << (result.is_prime ? "true" : "false")
+           << ", \"prime_high\": " << m.prime_high
+           << ", \"prime_low\": " << m.prime_low
+           << ", \"working_modulus\": " << m.working_modulus
+           << ", \"num_tests\": " << result.num_tests
+           << ", \"unique_hashes\": " << m.unique_hashes
+           << ", \"total_collisions\": " << m.total_collisions
+           << ", \"expected_collisions\": " << m.expected_collisions
+           << ", \"collision_ratio\": " << m.collision_ratio
+           << ", \"chi_square\": " << m.chi_square
+           << ", \"avalanche_score\": " << m.avalanche_score
+           << ", \"max_bucket_load\": " << m.max_bucket_load
+           << ", \"test_vectors\": {\"abc\": " << result.test_hash << "}"
+           << ", \"performance_ns_per_hash\": " << m.performance_ns_per_hash
+           << ", \"factors\": \"";
+        for (size_t i = 0; i < m.factors.size(); i++) {
+            ss << m.factors[i];
+            if (i < m.factors.size() - 1) ss << ", ";
+        }
+        ss << "\"}\n";
+        out_ << ss.str() << std::flush;
+    }
+};
+
+/**
+ * @brief Inserts each result into the modular_hash_results table of a SQLite database
+ */
+class SQLiteSweepSink : public SweepSink {
+private:
+    sqlite3* db_ = nullptr;
+    sqlite3_stmt* insert_stmt_ = nullptr;
+
+public:
+    /**
+     * @brief Open (or create) the database
+     * @param db_path Path to the SQLite database file
+     * @throws std::runtime_error if the database cannot be opened or its
+     * modular_hash_results table does not accept the sweep rows
+     */
+    explicit SQLiteSweepSink(const std::string& db_path) {
+        if (sqlite3_open(db_path.c_str(), &db_) != SQLITE_OK) {
+            std::string error = sqlite3_errmsg(db_);
+            sqlite3_close(db_);
+            throw std::runtime_error("Failed to open sweep database: " + error);
+        }
+        // Every batch is committed on its own so a long sweep can be resumed
+        sqlite3_exec(db_, "PRAGMA journal_mode=WAL;", nullptr, nullptr, nullptr);
+        sqlite3_exec(db_, "PRAGMA synchronous=NORMAL;", nullptr, nullptr, nullptr);
+        // Same schema as python/collect_modular_data.py
+        const char* create_sql = R"(
+            CREATE TABLE IF NOT EXISTS modular_hash_results (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                timestamp DATETIME DEFAULT CURRENT_TIMESTAMP,
+                table_size INTEGER,
+                is_prime BOOLEAN,
+                prime_high INTEGER,
+                prime_low INTEGER,
+                working_modulus INTEGER,
+                num_tests INTEGER,
+                unique_hashes INTEGER,
+                total_collisions INTEGER,
+                expected_collisions REAL,
+                collision_ratio REAL,
+                chi_square REAL,
+                avalanche_score REAL,
+                max_bucket_load INTEGER,
+                test_hash INTEGER,
+                performance_ns REAL,
+                factors TEXT
+            );
+            CREATE INDEX IF NOT EXISTS idx_table_size ON modular_hash_results(table_size);
+        )";
+        if (sqlite3_exec(db_, create_sql, nullptr, nullptr, nullptr) != SQLITE_OK) {
+            std::string error = sqlite3_errmsg(db_);
+            sqlite3_close(db_);
+            throw std::runtime_error("Failed to create sweep table: " + error);
+        }
+        int rc = sqlite3_prepare_v2(db_, R"(
+            INSERT INTO modular_hash_results
+            (table_size, is_prime, prime_high, prime_low, working_modulus,
+             num_tests, unique_hashes, total_collisions, expected_collisions,
+             collision_ratio, chi_square, avalanche_score, max_bucket_load,
+             test_hash, performance_ns, factors)
+            VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+        )", -1, &insert_stmt_, nullptr);
+        if (rc != SQLITE_OK) {
+            // e.g. an existing modular_hash_results table with another schema
+            std::string error = sqlite3_errmsg(db_);
+            sqlite3_finalize(insert_stmt_);
+            sqlite3_close(db_);
+            throw std::runtime_error("Failed to prepare sweep insert: " + error);
+        }
+    }
+
+    ~SQLiteSweepSink() {
+        if (insert_stmt_) sqlite3_finalize(insert_stmt_);
+        if (db_) sqlite3_close(db_);
+    }
+
+    void write(const SweepResult& result) override {
+        write_batch(std::span<const SweepResult>(&result, 1));
+    }
+
+    /**
+     * @brief Insert all results in one transaction
+     * @throws std::runtime_error if the transaction cannot be started or a row
+     * cannot be stored; the batch is rolled back
+     */
+    void write_batch(std::span<const SweepResult> results) override {
+        if (sqlite3_exec(db_, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            throw std::runtime_error(std::string("Failed to begin sweep transaction: ") + sqlite3_errmsg(db_));
+        }
+        try {
+            for (const SweepResult& result : results) {
+                insert(result);
+            }
+        } catch (...) {
+            sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+            throw;
+        }
+        if (sqlite3_exec(db_, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            std::string error = sqlite3_errmsg(db_);
+            sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+            throw std::runtime_error("Failed to commit sweep results: " + error);
+        }
+    }
+
+private:
+    void insert(const SweepResult& result) {
+        const CollectiveMetrics& m = result.metrics;
+        std::ostringstream factors;
+        for (size_t i = 0; i < m.factors.size(); i++) {
+            factors << m.factors[i];
+            if (i < m.factors.size() - 1) factors << ", ";
+        }
+        std::string factors_text = factors.str();
+        // SQLite integers are signed; the 64-bit values keep their bit pattern
+        sqlite3_bind_int64(insert_stmt_, 1, static_cast<int64_t>(m.table_size));
+        sqlite3_bind_int(insert_stmt_, 2, result.is_prime ? 1 : 0);
+        sqlite3_bind_int64(insert_stmt_, 3, static_cast<int64_t>(m.prime_high));
+        sqlite3_bind_int64(insert_stmt_, 4, static_cast<int64_t>(m.prime_low));
+        sqlite3_bind_int64(insert_stmt_, 5, static_cast<int64_t>(m.working_modulus));
+        sqlite3_bind_int64(insert_stmt_, 6, static_cast<int64_t>(result.num_tests));
+        sqlite3_bind_int64(insert_stmt_, 7, static_cast<int64_t>(m.unique_hashes));
+        sqlite3_bind_int64(insert_stmt_, 8, static_cast<int64_t>(m.total_collisions));
+        sqlite3_bind_double(insert_stmt_, 9, m.expected_collisions);
+        sqlite3_bind_double(insert_stmt_, 10, m.collision_ratio);
+        sqlite3_bind_double(insert_stmt_, 11, m.chi_square);
+        sqlite3_bind_double(insert_stmt_, 12, m.avalanche_score);
+        sqlite3_bind_int64(insert_stmt_, 13, static_cast<int64_t>(m.max_bucket_load));
+        sqlite3_bind_int64(insert_stmt_, 14, static_cast<int64_t>(result.test_hash));
+        sqlite3_bind_double(insert_stmt_, 15, m.performance_ns_per_hash);
+        sqlite3_bind_text(insert_stmt_, 16, factors_text.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(insert_stmt_) != SQLITE_DONE) {
+            std::string error = sqlite3_errmsg(db_);
+            sqlite3_reset(insert_stmt_);
+            throw std::runtime_error("Failed to store sweep result: " + error);
+        }
+        sqlite3_reset(insert_stmt_);
+    }
+};
+
+/**
+ * @brief Appends each result as a fixed-width record to a binary file
+ *
+ * The file is a 16-byte header ("GHSWEEP" and a NUL, then the format version
+ * and the record size as little-endian uint32) followed by Record structs in
+ * host byte order. numpy maps it in one call with the dtype in
+ * python/analyze_modular_results.py; the factors are left out because they
+ * follow from table_size. An existing file with the same header is appended to.
+ */
+class BinarySweepSink : public SweepSink {
+public:
+    static constexpr char MAGIC[8] = {'G', 'H', 'S', 'W', 'E', 'E', 'P', '\0'};
+    static constexpr uint32_t VERSION = 1;
+
+    struct Record {
+        uint64_t table_size;
+        uint64_t is_prime;
+        uint64_t prime_high;
+        uint64_t prime_low;
+        uint64_t working_modulus;
+        uint64_t num_tests;
+        uint64_t unique_hashes;
+        uint64_t total_collisions;
+        uint64_t max_bucket_load;
+        uint64_t test_hash;
+        double expected_collisions;
+        double collision_ratio;
+        double chi_square;
+        double avalanche_score;
+        double performance_ns;
+    };
+    static_assert(sizeof(Record) == 120, "Record must stay packed; the Python reader hardcodes its layout");
+
+private:
+    std::ofstream out_;
+    std::vector<Record> records_;
+
+public:
+    /**
+     * @brief Open (or create) the results file
+     * @param path Path to the results file
+     * @throws std::runtime_error if the file cannot be opened or has another format
+     */
+    explicit BinarySweepSink(const std::string& path) {
+        char header[16] = {};
+        bool existing = false;
+        {
+            std::ifstream in(path, std::ios::binary);
+            if (in && in.read(header, sizeof(header))) {
+                existing = true;
+            } else if (in && in.gcount() > 0) {
+                throw std::runtime_error("Truncated sweep results file: " + path);
+            }
+        }
+        uint32_t expected[2] = {VERSION, sizeof(Record)};
+        if (existing && (std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0 ||
+                         std::memcmp(header + 8, expected, sizeof(expected)) != 0)) {
+            throw std::runtime_error("Not a sweep results file of this version: " + path);
+        }
+        out_.open(path, std::ios::binary | std::ios::app);
+        if (!out_) {
+            throw std::runtime_error("Failed to open sweep results file: " + path);
+        }
+        if (!existing) {
+            std::memcpy(header, MAGIC, sizeof(MAGIC));
+            std::memcpy(header + 8, expected, sizeof(expected));
+            out_.write(header, sizeof(header));
+        }
+    }
+
+    void write(const SweepResult& result) override {
+        write_batch(std::span<const SweepResult>(&result, 1));
+    }
+
+    /**
+     * @brief Append all results with a single write and flush
+     * @throws std::runtime_error if the write fails
+     */
+    void write_batch(std::span<const SweepResult> results) override {
+        records_.clear();
+        for (const SweepResult& result : results) {
+            const CollectiveMetrics& m = result.metrics;
+            records_.push_back({m.table_size, result.is_prime ? 1u : 0u, m.prime_high, m.prime_low,
+                                m.working_modulus, result.num_tests, m.unique_hashes, m.total_collisions,
+                                m.max_bucket_load, result.test_hash, m.expected_collisions,
+                                m.collision_ratio, m.chi_square, m.avalanche_score,
+                                m.performance_ns_per_hash});
+        }
+        out_.write(reinterpret_cast<const char*>(records_.data()), records_.size() * sizeof(Record));
+        out_.flush();
+        if (!out_) {
+            throw std::runtime_error("Failed to append sweep results");
+        }
+    }
+};
+
+/**
+ * @brief Accepts results from any number of threads and stores them in batches
+ *
+ * push() hands a result to a lock-free MPSC queue and returns; a writer thread
+ * drains the queue and calls write_batch() on the target once batch_size
+ * results have gathered or the oldest waiting result is flush_interval old.
+ * A producer only waits when the queue is full. An exception thrown by the
+ * target stops the writer and is rethrown by close() and by later pushes.
+ */
+class AsyncSweepSink {
+private:
+    SweepSink& target_;
+    MpscQueue<SweepResult> queue_;
+    size_t batch_size_;
+    std::chrono::milliseconds flush_interval_;
+    std::atomic<bool> closing_{false};
+    std::atomic<bool> failed_{false};
+    std::exception_ptr error_;
+    std::thread writer_;
+
+    void drain() {
+        std::vector<SweepResult> batch;
+        batch.reserve(batch_size_);
+        auto oldest = std::chrono::steady_clock::now();
+        SweepResult result;
+        try {
+            for (;;) {
+                bool closing = closing_.load(std::memory_order_acquire);
+                while (batch.size() < batch_size_ && queue_.try_pop(result)) {
+                    if (batch.empty()) oldest = std::chrono::steady_clock::now();
+                    batch.push_back(std::move(result));
+                }
+                bool due = !batch.empty() &&
+                           (batch.size() >= batch_size_ || closing ||
+                            std::chrono::steady_clock::now() - oldest >= flush_interval_);
+                if (due) {
+                    target_.write_batch(batch);
+                    batch.clear();
+                    continue;
+                }
+                // Everything pushed before close() was drained by the pass above
+                if (closing && batch.empty()) return;
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        } catch (...) {
+            error_ = std::current_exception();
+            failed_.store(true, std::memory_order_release);
+        }
+    }
+
+public:
+    /**
+     * @param target Sink the batches are written to; must outlive this object
+     * @param batch_size Results per write_batch() call (default: 4096)
+     * @param flush_interval Longest time a result waits for its batch to fill (default: 250 ms)
+     * @param capacity Queue slots, rounded up to a power of two (default: 65536)
+     */
+    explicit AsyncSweepSink(SweepSink& target, size_t batch_size = 4096,
+                            std::chrono::milliseconds flush_interval = std::chrono::milliseconds(250),
+                            size_t capacity = 1 << 16)
+        : target_(target), queue_(capacity), batch_size_(std::max<size_t>(batch_size, 1)),
+          flush_interval_(flush_interval) {
+        writer_ = std::thread([this] { drain(); });
+    }
+
+    AsyncSweepSink(const AsyncSweepSink&) = delete;
+    AsyncSweepSink& operator=(const AsyncSweepSink&) = delete;
+
+    ~AsyncSweepSink() {
+        closing_.store(true, std::memory_order_release);
+        if (writer_.joinable()) writer_.join();
+    }
+
+    /**
+     * @brief Queue one result; safe to call from any thread
+     * @throws std::runtime_error if the target has failed
+     */
+    void push(SweepResult result) {
+        while (!queue_.try_push(std::move(result))) {
+            if (failed_.load(std::memory_order_acquire)) {
+                throw std::runtime_error("Sweep results writer has stopped");
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Write everything queued so far and stop the writer
+     * @details Call once no thread pushes any more.
+     * @throws The target's exception if a batch failed
+     */
+    void close() {
+        closing_.store(true, std::memory_order_release);
+        if (writer_.joinable()) writer_.join();
+        if (error_) std::rethrow_exception(error_);
+    }
+};
+
+/**
+ * @brief Measure every table size of a range and hand each result to a sink
+ * @details The keys are generated once. A table size uses the first
+ * tests_for_collisions(N, target_collisions) of them when target_collisions
+ * is positive, and all of them otherwise. Results reach the sink in batches
+ * in completion order, which with several threads is not the range order.
+ * @param range Table sizes to measure
+ * @param corpus_size Number of keys to generate; 0 sizes the corpus for the largest N
+ * @param target_collisions Expected collisions per table size, 0 to use the whole corpus
+ * @param reduction Range reduction of the measured hashers
+ * @param num_threads Number of worker threads, 0 for one per hardware thread
+ * @param sink Destination of the results
+ */
+inline void run_sweep(const SweepRange& range, uint64_t corpus_size, double target_collisions,
+                      Reduction reduction, size_t num_threads, SweepSink& sink) {
+    if (corpus_size == 0) {
+        if (target_collisions <= 0) {
+            throw std::invalid_argument("A sweep needs a key count or a collision target");
+        }
+        corpus_size = tests_for_collisions(range.at(range.count() - 1), target_collisions);
+    }
+    const std::vector<std::vector<uint8_t>> corpus = GoldenHash::generate_test_corpus(corpus_size);
+    std::span<const std::vector<uint8_t>> keys(corpus);
+
+    AsyncSweepSink results(sink);
+    ThreadPool pool(num_threads);
+    pool.parallel_for(range.count(), [&](size_t index, size_t) {
+        uint64_t table_size = range.at(index);
+        uint64_t num_tests = corpus_size;
+        if (target_collisions > 0) {
+            num_tests = std::min(num_tests, tests_for_collisions(table_size, target_collisions));
+        }
+        GoldenHash hasher(table_size, 0, reduction);
+        SweepResult result;
+        result.metrics = GoldenHash::run_tests_for(hasher, keys.first(num_tests));
+        result.num_tests = num_tests;
+        result.is_prime = detail::is_prime(table_size);
+        result.test_hash = hasher.hash(reinterpret_cast<const uint8_t*>("abc"), 3);
+        results.push(std::move(result));
+    });
+    results.close();
+}
+
+} // namespace goldenhash::tests
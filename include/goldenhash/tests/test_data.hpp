@@ -1,13 +1,22 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
+#include <bit>
+#include <charconv>
 #include <cstdint>
+#include <cstring>
 #include <string>
 #include <iostream>
 #include <array>
 #include <atomic>
 #include <thread>
 #include <random>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <mutex>
+#include <limits>
 
 namespace goldenhash::tests {
 
@@ -19,25 +28,154 @@ namespace goldenhash::tests {
  * Destructor must be implemented and clean up after itself
  * Must be thread-safe
  */
+/**
+ * @brief Append buffer for test data: keys packed back to back plus the end offset of each key
+ *
+ * Generator threads fill their own batch without any locking and hand it to
+ * TestData::add_batch() once it is full.
+ */
+class TestBatch {
+private:
+    std::vector<uint8_t> bytes_;
+    std::vector<uint64_t> ends_;
+public:
+    void add(std::string_view test) {
+        bytes_.insert(bytes_.end(), test.begin(), test.end());
+        ends_.push_back(bytes_.size());
+    }
+
+    /**
+     * @brief Append a key of len bytes and return them to be filled in
+     * @details The pointer is valid until the next add.
+     */
+    uint8_t* add_uninitialized(size_t len) {
+        size_t start = bytes_.size();
+        bytes_.resize(start + len);
+        ends_.push_back(bytes_.size());
+        return bytes_.data() + start;
+    }
+
+    void clear() {
+        bytes_.clear();
+        ends_.clear();
+    }
+
+    size_t size() const { return ends_.size(); }
+
+    /**
+     * @brief All keys of the batch, back to back
+     */
+    std::span<const uint8_t> bytes() const { return bytes_; }
+
+    /**
+     * @brief Bytes of the key at index
+     */
+    std::span<const uint8_t> view(size_t index) const {
+        size_t begin = index == 0 ? 0 : ends_[index - 1];
+        return std::span<const uint8_t>(bytes_).subspan(begin, ends_[index] - begin);
+    }
+};
+
 class TestData {
 public:
     virtual ~TestData() = default;
     virtual void add_test(const std::string& test) = 0;
+    /**
+     * @brief Append every key of a batch, in order
+     * @details The default adds the keys one at a time; packed backends copy the whole batch at once.
+     * @param batch Keys to append
+     */
+    virtual void add_batch(const TestBatch& batch) {
+        for (size_t i = 0; i < batch.size(); i++) {
+            std::span<const uint8_t> test = batch.view(i);
+            add_test(std::string(test.begin(), test.end()));
+        }
+    }
     virtual void clean_up() = 0;
     virtual std::string get_test(size_t index) = 0;
+    /**
+     * @brief View of a test's bytes without copying them
+     * @details Stays valid until the data is modified. Backends without stable
+     * storage return a view into a thread-local buffer instead, which the next
+     * get_view() call on the same thread replaces.
+     * @param index Test index
+     * @return Bytes of the test
+     */
+    virtual std::span<const uint8_t> get_view(size_t index) = 0;
     virtual size_t size() = 0;
 };
 
 /**
- * @brief Creates N number of tests in the test data
- * @param progress_counter Optional atomic counter to track progress
+ * @brief Four interleaved xoshiro256++ generators
+ *
+ * The lanes are stored structure-of-arrays so that one step of all four
+ * compiles to a few vector instructions; operator() hands out the buffered
+ * words one at a time. About an order of magnitude faster than drawing every
+ * character from std::mt19937 through a distribution.
  */
-inline static void create_test_data(TestData* data, size_t start_index, size_t end_index, std::atomic<size_t>* progress_counter = nullptr) {
-    // Use thread-local random generator to avoid race conditions
-    // Use random_device for better randomness instead of predictable seed
-    static thread_local std::random_device rd;
-    static thread_local std::mt19937 rng(rd());
-    const std::array<std::string, 8> test_strings = {
+class Xoshiro256x4 {
+private:
+    static constexpr size_t LANES = 4;
+    static constexpr size_t STEPS = 4;  // Steps of every lane per refill
+
+    alignas(32) uint64_t state_[4][LANES];
+    alignas(32) uint64_t buffer_[STEPS * LANES];
+    size_t next_ = STEPS * LANES;
+
+    void refill() {
+        for (size_t step = 0; step < STEPS; ++step) {
+            for (size_t lane = 0; lane < LANES; ++lane) {
+                buffer_[step * LANES + lane] = std::rotl(state_[0][lane] + state_[3][lane], 23) + state_[0][lane];
+                uint64_t t = state_[1][lane] << 17;
+                state_[2][lane] ^= state_[0][lane];
+                state_[3][lane] ^= state_[1][lane];
+                state_[1][lane] ^= state_[2][lane];
+                state_[0][lane] ^= state_[3][lane];
+                state_[2][lane] ^= t;
+                state_[3][lane] = std::rotl(state_[3][lane], 45);
+            }
+        }
+        next_ = 0;
+    }
+
+public:
+    /**
+     * @param seed Expanded into the lane states with splitmix64
+     */
+    explicit Xoshiro256x4(uint64_t seed) {
+        for (auto& word : state_) {
+            for (uint64_t& lane : word) {
+                uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                lane = z ^ (z >> 31);
+            }
+        }
+    }
+
+    uint64_t operator()() {
+        if (next_ == STEPS * LANES) refill();
+        return buffer_[next_++];
+    }
+};
+
+/**
+ * @brief Writes the test keys straight into a TestBatch
+ *
+ * Keys come in groups of 20: the 8 fixed strings, 8 random strings of 8-31
+ * characters from 'a' onwards and 4 random byte strings of 8-23 bytes, each
+ * followed by a space and its index (except key 0). The keys after the last
+ * whole group of a range are "RANDOM_<index>".
+ */
+class TestKeyGenerator {
+public:
+    static constexpr size_t GROUP_KEYS = 20;
+    // Ranges are generated in batches of this size; being whole groups, the split does not change the keys
+    static constexpr size_t BATCH_KEYS = 4000;
+    static_assert(BATCH_KEYS % GROUP_KEYS == 0);
+
+private:
+    static constexpr std::array<std::string_view, 8> FIXED_STRINGS = {
         "",
         "Hello, World!",
         "1234567890",
@@ -47,132 +185,209 @@ inline static void create_test_data(TestData* data, size_t start_index, size_t e
         "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
         "The quick brown fox jumps over the lazy dog"
     };
-    if (start_index >= end_index) {
-        throw std::invalid_argument("start_index must be less than end_index");
+
+    Xoshiro256x4 rng_;
+
+    /**
+     * @brief Append body, followed by a space and the index unless it is 0
+     */
+    static void add_key(TestBatch& batch, std::string_view body, size_t index) {
+        char suffix[24];
+        size_t suffix_len = 0;
+        if (index > 0) {
+            suffix[0] = ' ';
+            suffix_len = std::to_chars(suffix + 1, suffix + sizeof(suffix), index).ptr - suffix;
+        }
+        uint8_t* key = batch.add_uninitialized(body.size() + suffix_len);
+        std::copy(body.begin(), body.end(), key);
+        std::copy(suffix, suffix + suffix_len, key + body.size());
+    }
+
+    /**
+     * @brief Uniform length in [min, min + span) from the high half of a random word
+     */
+    size_t random_length(size_t min, size_t span) {
+        return min + static_cast<size_t>(((rng_() >> 32) * span) >> 32);
     }
-    size_t number_of_tests = end_index - start_index;
-    // Get the total number of tests / 20
-    size_t tests_per_iteration = number_of_tests / 20;
-    // Adjust the number of tests to be a multiple of 20, we will do the remainder separately
-    size_t remainder = number_of_tests % 20;
-
-    size_t progress_batch = 0;
-    for (size_t i = 0; i < tests_per_iteration; ++i) {
-        size_t current_index = start_index + i * 20;
-        // Add test strings (up to 8)
-        for (const auto& str : test_strings) {
-            if (current_index >= end_index) break;
-            if (current_index > 0) {
-                data->add_test(str + " " + std::to_string(current_index));
-            } else {
-                data->add_test(str);
+
+public:
+    explicit TestKeyGenerator(uint64_t seed) : rng_(seed) {}
+
+    /**
+     * @brief Append the keys with indices [start_index, end_index) to the batch
+     */
+    void generate(TestBatch& batch, size_t start_index, size_t end_index) {
+        size_t groups = (end_index - start_index) / GROUP_KEYS;
+        size_t index = start_index;
+        char text[32];
+        for (size_t group = 0; group < groups; ++group) {
+            for (std::string_view str : FIXED_STRINGS) {
+                add_key(batch, str, index++);
             }
-            current_index++;
-        }
-        
-        // Add random alphanumeric strings (up to 8)
-        for (size_t j = 0; j < 8 && current_index < end_index; ++j) {
-            std::string random_str;
-            std::uniform_int_distribution<int> len_dist(8, 31);
-            uint8_t len = len_dist(rng); // Random length between 8 and 31
-            random_str.resize(len);
-            std::uniform_int_distribution<int> char_dist(0, 31);
-            for (size_t k = 0; k < len; ++k) {
-                random_str[k] = 'a' + char_dist(rng); // Simple lowercase letters and some characters
+            // Five bits per character, twelve characters per random word
+            for (size_t j = 0; j < 8; ++j) {
+                size_t len = random_length(8, 24);
+                uint64_t bits = 0;
+                for (size_t k = 0; k < len; ++k) {
+                    if (k % 12 == 0) bits = rng_();
+                    text[k] = static_cast<char>('a' + (bits & 31));
+                    bits >>= 5;
+                }
+                add_key(batch, std::string_view(text, len), index++);
             }
-            if (current_index > 0) {
-                data->add_test(random_str + " " + std::to_string(current_index));
-            } else {
-                data->add_test(random_str);
+            for (size_t j = 0; j < 4; ++j) {
+                size_t len = random_length(8, 16);
+                for (size_t k = 0; k < len; k += 8) {
+                    uint64_t bits = rng_();
+                    std::memcpy(text + k, &bits, sizeof(bits));
+                }
+                add_key(batch, std::string_view(text, len), index++);
             }
-            current_index++;
         }
-        
-        // Add random bytes (up to 4)
-        std::uniform_int_distribution<int> byte_len_dist(8, 23);
-        std::uniform_int_distribution<int> byte_dist(0, 255);
-        for (size_t j = 0; j < 4 && current_index < end_index; ++j) {
-            std::vector<uint8_t> random_bytes(byte_len_dist(rng)); // Random length between 8 and 23
-            for (auto& byte : random_bytes) {
-                byte = byte_dist(rng); // Random byte
-            }
-            std::string byte_str(random_bytes.begin(), random_bytes.end());
-            if (current_index > 0) {
-                data->add_test(byte_str + " " + std::to_string(current_index));
-            } else {
-                data->add_test(byte_str);
-            }
-            current_index++;
-            progress_batch++;
-            
-            // Update progress every 1024 items
-            if (progress_counter && progress_batch >= 1024) {
-                progress_counter->fetch_add(progress_batch, std::memory_order_relaxed);
-                progress_batch = 0;
-            }
+        for (; index < end_index; ++index) {
+            std::memcpy(text, "RANDOM_", 7);
+            size_t len = std::to_chars(text + 7, text + sizeof(text), index).ptr - text;
+            batch.add(std::string_view(text, len));
         }
     }
-    // Add the remainder
-    for (size_t i = 0; i < remainder; ++i) {
-        size_t current_index = start_index + tests_per_iteration * 20 + i;
-        if (current_index >= end_index) break;
-        // Add a random string
-        std::string random_str = "RANDOM_" + std::to_string(current_index);
-        data->add_test(random_str);
+};
+
+/**
+ * @brief Creates N number of tests in the test data
+ * @param progress_counter Optional atomic counter to track progress
+ */
+inline static void create_test_data(TestData* data, size_t start_index, size_t end_index, std::atomic<size_t>* progress_counter = nullptr) {
+    // Use a thread-local generator to avoid race conditions
+    // Use random_device for better randomness instead of predictable seed
+    static thread_local std::random_device rd;
+    static thread_local TestKeyGenerator generator((static_cast<uint64_t>(rd()) << 32) | rd());
+    if (start_index >= end_index) {
+        throw std::invalid_argument("start_index must be less than end_index");
     }
-    // Update any remaining progress
-    if (progress_counter && progress_batch > 0) {
-        progress_counter->fetch_add(progress_batch, std::memory_order_relaxed);
+    // Keys are collected without locking and handed over in batches
+    TestBatch batch;
+    for (size_t first = start_index; first < end_index; first += TestKeyGenerator::BATCH_KEYS) {
+        size_t last = std::min(end_index, first + TestKeyGenerator::BATCH_KEYS);
+        batch.clear();
+        generator.generate(batch, first, last);
+        data->add_batch(batch);
+        if (progress_counter) {
+            progress_counter->fetch_add(last - first, std::memory_order_relaxed);
+        }
     }
 }
 
 /**
  * @brief In-memory test data implementation
  * 
- * This class stores test data in a vector and provides methods to access it.
+ * All keys are packed back to back into one byte arena. Key i ends at
+ * block_starts_[i / BLOCK_KEYS] + ends_[i], so the offset table needs 4 bytes
+ * per key instead of a 32-byte std::string plus a heap block, and reading the
+ * keys in order walks memory sequentially.
  * It is suitable for tests that can fit entirely in memory.
+ * Keys must not be added while they are being read.
  */
 class InMemoryTestData : public TestData {
 private:
-    std::vector<std::string> tests;
-    std::atomic<bool> in_use{false};
+    // Keys per block of the offset table; the offsets within a block are 32-bit
+    static constexpr size_t BLOCK_KEYS = 4096;
+
+    std::vector<uint8_t> arena_;
+    std::vector<uint64_t> block_starts_;  // Arena offset of the first key of each block
+    std::vector<uint32_t> ends_;          // End of each key, relative to its block start
+    std::mutex mutex_;
+
+    /**
+     * @brief Record the arena offsets of the next key
+     * @param start Arena offset of the key's first byte
+     * @param end Arena offset one past the key's last byte
+     */
+    void push_key(uint64_t start, uint64_t end) {
+        if (ends_.size() % BLOCK_KEYS == 0) {
+            block_starts_.push_back(start);
+        }
+        uint64_t relative = end - block_starts_.back();
+        if (relative > std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("Test keys too large for the packed offset table");
+        }
+        ends_.push_back(static_cast<uint32_t>(relative));
+    }
+
+    uint64_t end_of(size_t index) const {
+        return block_starts_[index / BLOCK_KEYS] + ends_[index];
+    }
+
+    uint64_t start_of(size_t index) const {
+        return index % BLOCK_KEYS == 0 ? block_starts_[index / BLOCK_KEYS] : end_of(index - 1);
+    }
+
 public:
+    /**
+     * @param initial_size Number of keys to reserve room for
+     */
     InMemoryTestData(size_t initial_size = 1000) {
-        tests.reserve(initial_size);
+        ends_.reserve(initial_size);
+        block_starts_.reserve(initial_size / BLOCK_KEYS + 1);
     }
 
     void add_test(const std::string& test) override {
-        bool expected = false;
-        while (!in_use.compare_exchange_strong(expected, true,
-                std::memory_order_acquire, std::memory_order_relaxed)) {
-            expected = false;
-            std::this_thread::yield();
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t start = arena_.size();
+        push_key(start, start + test.size());
+        arena_.insert(arena_.end(), test.begin(), test.end());
+    }
+
+    void add_batch(const TestBatch& batch) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t keys_before = ends_.size();
+        size_t blocks_before = block_starts_.size();
+        uint64_t batch_start = arena_.size();
+        std::span<const uint8_t> bytes = batch.bytes();
+        try {
+            for (size_t i = 0; i < batch.size(); i++) {
+                std::span<const uint8_t> test = batch.view(i);
+                uint64_t start = batch_start + (test.data() - bytes.data());
+                push_key(start, start + test.size());
+            }
+        } catch (...) {
+            ends_.resize(keys_before);
+            block_starts_.resize(blocks_before);
+            throw;
         }
-        tests.push_back(test);
-        in_use.store(false, std::memory_order_release);
+        arena_.insert(arena_.end(), bytes.begin(), bytes.end());
     }
 
     void clean_up() override {
-        tests.clear();
+        std::lock_guard<std::mutex> lock(mutex_);
+        arena_.clear();
+        block_starts_.clear();
+        ends_.clear();
     }
 
     std::string get_test(size_t index) override {
-        if (index >= tests.size()) {
+        std::span<const uint8_t> test = get_view(index);
+        return std::string(test.begin(), test.end());
+    }
+
+    std::span<const uint8_t> get_view(size_t index) override {
+        if (index >= ends_.size()) {
             throw std::out_of_range("Index out of range");
         }
-        return tests[index];
+        uint64_t start = start_of(index);
+        return {arena_.data() + start, static_cast<size_t>(end_of(index) - start)};
     }
 
-    size_t size() override{
-        bool expected = false;
-        while (!in_use.compare_exchange_strong(expected, true,
-                std::memory_order_acquire, std::memory_order_relaxed)) {
-            expected = false;
-            std::this_thread::yield();
-        }
-        size_t size = tests.size();
-        in_use.store(false, std::memory_order_release);
-        return size;
+    size_t size() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ends_.size();
+    }
+
+    /**
+     * @brief Bytes held by the arena and the offset table
+     */
+    size_t memory_usage() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return arena_.capacity() + block_starts_.capacity() * sizeof(uint64_t) + ends_.capacity() * sizeof(uint32_t);
     }
 };
 
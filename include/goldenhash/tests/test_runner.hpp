@@ -4,11 +4,13 @@
 #include "metrics.hpp"
 #include "collision_store.hpp"
 #include "hash64_analyzer.hpp"
+#include <goldenhash/thread_pool.hpp>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 #include <cmath>
 #include <random>
+#include <span>
 
 namespace goldenhash::tests {
 
@@ -19,28 +21,31 @@ class TestRunner {
 private:
     std::vector<MapShard*> shards_;
     TestData* test_data_;
-    GoldenHash& hasher_;
+    const GoldenHash& hasher_;
+    const HashAlgorithm& algorithm_;
     ComparisonResult result_;
     size_t number_of_important_bits_{0};
-    std::unique_ptr<std::thread> performance_thread;
-    std::unique_ptr<std::thread> metrics_thread;
     
     // Metrics collectors
     std::unique_ptr<AvalancheAnalyzer> avalanche_analyzer_;
     std::unique_ptr<ChiSquaredCalculator> chi_squared_calc_;
     std::unique_ptr<CollisionAnalyzer> collision_analyzer_;
-    std::unique_ptr<CollisionStore> collision_store_;
-    std::unique_ptr<Hash64Analyzer> hash64_analyzer_;
+    std::shared_ptr<CollisionStore> collision_store_;
+    std::shared_ptr<Hash64Analyzer> hash64_analyzer_;
     
     bool collect_metrics_ = false;
     bool store_collisions_ = false;
     bool analyze_64bit_ = false;
-    
-public:
+    size_t avalanche_stride_ = 100;
+    uint64_t first_index_ = 0;
+    bool perf_counters_ = false;
+    volatile uint64_t benchmark_checksum_ = 0;
     std::atomic<bool> performance_benchmark_complete_{false};
     std::atomic<bool> metrics_collection_complete_{false};
-
-    TestRunner(std::vector<MapShard*> shards, TestData* test_data, GoldenHash& hasher, std::string algorithm, size_t table_size) : shards_(shards), test_data_(test_data), hasher_(hasher) {
+    
+public:
+    TestRunner(std::vector<MapShard*> shards, TestData* test_data, const GoldenHash& hasher, std::string algorithm, size_t table_size)
+        : shards_(shards), test_data_(test_data), hasher_(hasher), algorithm_(find_hash_algorithm(algorithm)) {
         if (shards_.size() != 64) {
             throw std::runtime_error("These tests require exactly 64 shards");
         }
@@ -76,187 +81,376 @@ public:
 
     /**
      * @brief Enable metrics collection
+     * @details The store and the 64-bit analyzer are shared by the runners of
+     * all partitions: every runner records the collisions within its own
+     * partition and adds all of its full hashes to the one analyzer.
      * @param chi_squared_buckets Number of buckets for chi-squared test
-     * @param collision_db_path Optional path to collision database
-     * @param analyze_64bit Enable 64-bit hash analysis (no modulo)
+     * @param collision_store Store for collision records and the run, or nullptr
+     * @param hash64_analyzer 64-bit hash analysis (no modulo) of all partitions, or nullptr
+     * @param dense_buckets Bitmap over the table shared by the runners of this run,
+     * used for collision counting unless collisions are stored
+     * @param avalanche_stride Run the avalanche test on every avalanche_stride-th key
+     * @param sac_input_bits Input bits covered by the SAC/BIC matrices, 0 to skip them
+     * @param first_index Index of this partition's first key in the whole test data,
+     * which the indices of collision records are relative to
      */
-    void enable_metrics(size_t chi_squared_buckets = 256, const std::string& collision_db_path = "", 
-                       bool analyze_64bit = false) {
+    void enable_metrics(size_t chi_squared_buckets = 256, std::shared_ptr<CollisionStore> collision_store = nullptr,
+                       std::shared_ptr<Hash64Analyzer> hash64_analyzer = nullptr,
+                       std::shared_ptr<DenseHashSet> dense_buckets = nullptr,
+                       size_t avalanche_stride = 100, size_t sac_input_bits = 0, uint64_t first_index = 0) {
         collect_metrics_ = true;
+        avalanche_stride_ = std::max<size_t>(avalanche_stride, 1);
+        first_index_ = first_index;
         
         // Initialize metrics collectors
-        avalanche_analyzer_ = std::make_unique<AvalancheAnalyzer>(number_of_important_bits_);
+        avalanche_analyzer_ = std::make_unique<AvalancheAnalyzer>(number_of_important_bits_, sac_input_bits);
         chi_squared_calc_ = std::make_unique<ChiSquaredCalculator>(chi_squared_buckets);
-        collision_analyzer_ = std::make_unique<CollisionAnalyzer>(result_.table_size);
-        
-        if (!collision_db_path.empty()) {
+        if (collision_store) {
             store_collisions_ = true;
-            collision_store_ = std::make_unique<SQLiteCollisionStore>(collision_db_path);
-            collision_store_->initialize();
+            collision_store_ = std::move(collision_store);
         }
-        
-        analyze_64bit_ = analyze_64bit;
-        if (analyze_64bit) {
-            hash64_analyzer_ = std::make_unique<Hash64Analyzer>(collision_db_path, test_data_->size());
+        // Stored collisions need the partner of every collision, which only the sparse analyzer knows
+        if (dense_buckets && !store_collisions_) {
+            collision_analyzer_ = std::make_unique<CollisionAnalyzer>(std::move(dense_buckets));
+        } else {
+            collision_analyzer_ = std::make_unique<CollisionAnalyzer>(result_.table_size);
         }
+        
+        analyze_64bit_ = hash64_analyzer != nullptr;
+        hash64_analyzer_ = std::move(hash64_analyzer);
     }
     
     /**
-     * @brief Run metrics collection (separate thread)
+     * @brief Read hardware counters around the benchmark loop
+     * @details The counters are opened by run_performance_benchmark() on the
+     * thread that runs it, which throws if they cannot be opened.
+     */
+    void enable_perf_counters() {
+        perf_counters_ = true;
+    }
+    
+    /**
+     * @brief Collect quality metrics over the whole test data on the calling thread
+     * @details Touches only the metrics fields of the result, so it may run
+     * concurrently with run_performance_benchmark() on another thread.
      */
     void run_metrics_collection() {
         if (!collect_metrics_ || !test_data_) return;
+        size_t num_tests = test_data_->size();
+        std::vector<CollisionRecord> collision_batch;
         
-        metrics_thread = std::make_unique<std::thread>([this]() {
-            size_t num_tests = test_data_->size();
-            std::vector<CollisionRecord> collision_batch;
-            
-            // Collect metrics on test data
+        // Collect metrics on test data
+        MetricsScratch scratch;
+        HashFunction hash_function = algorithm_.make(result_.table_size, hasher_);
+        // The 64-bit analysis hashes without the final modulo
+        HashFunction full_hash_function = algorithm_.make(FULL_HASH, hasher_);
+        std::visit([&](auto& hash_fn) {
+            using Fn = std::decay_t<decltype(hash_fn)>;
+            Fn* full_hash_fn = analyze_64bit_ ? &std::get<Fn>(full_hash_function) : nullptr;
             for (size_t i = 0; i < num_tests; ++i) {
-                std::string data_str = test_data_->get_test(i);
-                std::vector<uint8_t> data(data_str.begin(), data_str.end());
-                uint64_t hash = compute_hash(result_.algorithm, data.data(), data.size(), 
-                                           result_.table_size, hasher_);
-                
-                // Chi-squared distribution
-                chi_squared_calc_->add_sample(hash, result_.table_size);
-                
-                // Collision analysis
-                size_t prev_collisions = collision_analyzer_->get_actual_collisions();
-                collision_analyzer_->add_hash(hash, i);
-                
-                // 64-bit hash analysis (if enabled)
-                if (analyze_64bit_) {
-                    // Get the full 64-bit hash without modulo
-                    uint64_t full_hash = compute_hash(result_.algorithm, data.data(), data.size(), 
-                                                    UINT64_MAX, hasher_);  // No modulo
-                    hash64_analyzer_->add_hash(full_hash, data.data(), data.size());
-                }
-                
-                // If a new collision was detected, store it
-                if (store_collisions_ && collision_analyzer_->get_actual_collisions() > prev_collisions) {
-                    // Find the previous occurrence
-                    for (size_t j = 0; j < i; ++j) {
-                        std::string prev_data_str = test_data_->get_test(j);
-                        std::vector<uint8_t> prev_data(prev_data_str.begin(), prev_data_str.end());
-                        uint64_t prev_hash = compute_hash(result_.algorithm, prev_data.data(), 
-                                                        prev_data.size(), result_.table_size, hasher_);
-                        if (prev_hash == hash) {
-                            CollisionRecord record;
-                            record.hash_value = hash;
-                            record.input1 = prev_data;
-                            record.input2 = data;
-                            record.input1_index = j;
-                            record.input2_index = i;
-                            record.timestamp = std::chrono::system_clock::now().time_since_epoch().count();
-                            record.algorithm = result_.algorithm;
-                            record.table_size = result_.table_size;
-                            collision_batch.push_back(record);
-                            break;
-                        }
-                    }
-                }
-                
-                // Avalanche effect - test with bit flips
-                if (i % 100 == 0 && data.size() > 0) {  // Sample every 100th entry
-                    for (size_t byte_idx = 0; byte_idx < data.size(); ++byte_idx) {
-                        for (int bit = 0; bit < 8; ++bit) {
-                            // Flip one bit
-                            data[byte_idx] ^= (1 << bit);
-                            uint64_t hash_flipped = compute_hash(result_.algorithm, data.data(), 
-                                                               data.size(), result_.table_size, hasher_);
-                            avalanche_analyzer_->add_sample(hash, hash_flipped);
-                            // Flip back
-                            data[byte_idx] ^= (1 << bit);
-                        }
-                    }
+                std::span<const uint8_t> data = test_data_->get_view(i);
+                uint64_t hash = 0;
+                uint64_t partner = collect_key_metrics(hash_fn, full_hash_fn, data, i, hash, scratch);
+            
+                // If a new collision was detected, store it with the input it collided with
+                if (store_collisions_ && partner != CollisionAnalyzer::NO_PARTNER && partner != CollisionAnalyzer::UNKNOWN_PARTNER) {
+                    // Views from thread-local backends are replaced by the next get_view()
+                    CollisionRecord record;
+                    record.hash_value = hash;
+                    record.input2.assign(data.begin(), data.end());
+                    std::span<const uint8_t> prev_data = test_data_->get_view(partner);
+                    record.input1.assign(prev_data.begin(), prev_data.end());
+                    record.input1_index = first_index_ + partner;
+                    record.input2_index = first_index_ + i;
+                    record.timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+                    record.algorithm = result_.algorithm;
+                    record.table_size = result_.table_size;
+                    collision_batch.push_back(std::move(record));
                 }
             }
-            
-            // Store collision batch
-            if (store_collisions_ && !collision_batch.empty()) {
-                collision_store_->store_collisions_batch(collision_batch);
+        }, hash_function);
+        flush_full_hashes(scratch);
+        
+        // Store collision batch
+        if (store_collisions_ && !collision_batch.empty()) {
+            collision_store_->store_collisions_batch(collision_batch);
+        }
+        
+        update_metric_results();
+        metrics_collection_complete_.store(true);
+    }
+
+    /**
+     * @brief Fold the metrics of runners over other partitions into this runner's
+     * @details The collision counts are merged one hash partition per pool item,
+     * so the reduction runs on every worker of the pool. Collision records and
+     * the 64-bit analysis already went to the shared store and analyzer.
+     * @param others Runners whose run_metrics_collection() has finished
+     * @param pool Pool to run the reduction on; must not be running a job
+     */
+    void merge_metrics(const std::vector<TestRunner*>& others, ThreadPool& pool) {
+        if (!metrics_collection_complete_.load()) {
+            throw std::runtime_error("Metrics collection must finish before other metrics are merged");
+        }
+        for (const TestRunner* other : others) {
+            if (!other->metrics_collection_complete_.load()) {
+                throw std::runtime_error("Cannot merge metrics that have not been collected");
             }
-            
-            // Update result with metrics
-            result_.avalanche_score = avalanche_analyzer_->get_avalanche_score();
-            result_.avalanche_bias = avalanche_analyzer_->get_avalanche_bias();
-            result_.chi_squared = chi_squared_calc_->get_chi_squared();
-            result_.uniformity_score = chi_squared_calc_->get_uniformity_score();
-            result_.collision_ratio = collision_analyzer_->get_collision_ratio();
-            result_.actual_collisions = collision_analyzer_->get_actual_collisions();
-            result_.expected_collisions = collision_analyzer_->get_expected_collisions();
-            result_.load_factor = collision_analyzer_->get_load_factor();
-            result_.metrics_collected = true;
-            
-            // Store test run if we have a collision store
-            if (store_collisions_) {
-                TestRunRecord run_record;
-                run_record.run_id = generate_run_id(result_.algorithm);
-                run_record.algorithm = result_.algorithm;
-                run_record.table_size = result_.table_size;
-                run_record.num_hashes = num_tests;
-                run_record.timestamp = std::chrono::system_clock::now().time_since_epoch().count();
-                run_record.avalanche_score = result_.avalanche_score;
-                run_record.chi_squared = result_.chi_squared;
-                run_record.collision_ratio = result_.collision_ratio;
-                run_record.actual_collisions = result_.actual_collisions;
-                run_record.expected_collisions = result_.expected_collisions;
-                run_record.throughput_mbs = result_.throughput_mbs;
-                run_record.ns_per_hash = result_.ns_per_hash;
-                
-                collision_store_->store_test_run(run_record);
-                
-                // Also save 64-bit analysis if enabled
-                if (analyze_64bit_) {
-                    std::string metadata = "{\"table_size\": " + std::to_string(result_.table_size) + 
-                                         ", \"analysis\": \"" + hash64_analyzer_->get_statistics() + "\"}";
-                    hash64_analyzer_->save_results(result_.algorithm, metadata);
-                }
+            avalanche_analyzer_->merge(*other->avalanche_analyzer_);
+            chi_squared_calc_->merge(*other->chi_squared_calc_);
+        }
+        pool.parallel_for(CollisionAnalyzer::PARTITIONS, [&](size_t partition, size_t) {
+            for (const TestRunner* other : others) {
+                collision_analyzer_->merge_partition(*other->collision_analyzer_, partition);
             }
-            
-            metrics_collection_complete_.store(true);
-            metrics_collection_complete_.notify_all();
         });
-        metrics_thread->detach();
+        for (const TestRunner* other : others) {
+            collision_analyzer_->finish_merge(*other->collision_analyzer_);
+        }
+        update_metric_results();
+    }
+
+    /**
+     * @brief Record the run in the collision store, if there is one
+     * @details Call on the runner the others were merged into, once the
+     * benchmark and the metrics collection have finished on every runner. The
+     * run covers all partitions, and so does the shared 64-bit analysis saved with it.
+     */
+    void store_test_run() {
+        if (!metrics_collection_complete_.load() || !performance_benchmark_complete_.load()) {
+            throw std::runtime_error("Benchmark and metrics collection must finish before the run is stored");
+        }
+        // Store test run if we have a collision store
+        if (store_collisions_) {
+            size_t num_tests = collision_analyzer_->get_total_hashes();
+            TestRunRecord run_record;
+            run_record.run_id = generate_run_id(result_.algorithm);
+            run_record.algorithm = result_.algorithm;
+            run_record.table_size = result_.table_size;
+            run_record.num_hashes = num_tests;
+            run_record.timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+            run_record.avalanche_score = result_.avalanche_score;
+            run_record.chi_squared = result_.chi_squared;
+            run_record.collision_ratio = result_.collision_ratio;
+            run_record.actual_collisions = result_.actual_collisions;
+            run_record.expected_collisions = result_.expected_collisions;
+            run_record.throughput_mbs = result_.throughput_mbs;
+            run_record.ns_per_hash = result_.ns_per_hash;
+        
+            collision_store_->store_test_run(run_record);
+        
+            // Also save 64-bit analysis if enabled
+            if (analyze_64bit_) {
+                std::string metadata = "{\"table_size\": " + std::to_string(result_.table_size) + 
+                                     ", \"analysis\": \"" + hash64_analyzer_->get_statistics() + "\"}";
+                hash64_analyzer_->save_results(result_.algorithm, metadata);
+            }
+        }
     }
     
+private:
     /**
-     * @brief Runs the performance benchmark (single-threaded)
+     * @brief Buffers reused by collect_key_metrics() from one key to the next
+     */
+    struct MetricsScratch {
+        FlipScratch flips;
+        std::vector<uint64_t> flipped_hashes;
+        std::vector<uint64_t> full_hashes;  // Collected for the shared 64-bit analyzer
+    };
+
+    // Full hashes handed to the shared 64-bit analyzer per lock
+    static constexpr size_t FULL_HASH_BATCH = 4096;
+
+    /**
+     * @brief Hand the collected full hashes to the 64-bit analyzer
+     */
+    void flush_full_hashes(MetricsScratch& scratch) {
+        if (!scratch.full_hashes.empty()) {
+            hash64_analyzer_->add_hashes(scratch.full_hashes);
+            scratch.full_hashes.clear();
+        }
+    }
+
+    /**
+     * @brief Feed one key into every metrics collector
+     * @param hash_fn Hash function reduced to the table size
+     * @param full_hash_fn The same function without reduction, or nullptr without 64-bit analysis
+     * @param data The key
+     * @param index Index of the key within this runner's keys
+     * @param hash Receives the key's hash
+     * @param scratch Buffers for the avalanche test
+     * @return Index of the key this one collided with, as returned by CollisionAnalyzer::add_hash()
+     */
+    template <typename Fn>
+    uint64_t collect_key_metrics(Fn& hash_fn, Fn* full_hash_fn, std::span<const uint8_t> data, size_t index,
+                                 uint64_t& hash, MetricsScratch& scratch) {
+        hash = hash_fn(data.data(), data.size());
+
+        // Chi-squared distribution
+        chi_squared_calc_->add_sample(hash, result_.table_size);
+
+        // Collision analysis; the analyzer remembers the first input of every value
+        uint64_t partner = collision_analyzer_->add_hash(hash, index);
+
+        // 64-bit hash analysis (if enabled)
+        if (full_hash_fn) {
+            // Get the full 64-bit hash without modulo
+            scratch.full_hashes.push_back((*full_hash_fn)(data.data(), data.size()));
+            if (scratch.full_hashes.size() >= FULL_HASH_BATCH) {
+                flush_full_hashes(scratch);
+            }
+        }
+
+        // Avalanche effect - hash every single-bit flip of the key in one batch
+        if (index % avalanche_stride_ == 0 && data.size() > 0) {
+            scratch.flipped_hashes.resize(8 * data.size());
+            compute_flip_hashes(hash_fn, data.data(), data.size(), scratch.flipped_hashes.data(), scratch.flips);
+            avalanche_analyzer_->add_flips(hash, scratch.flipped_hashes.data(), scratch.flipped_hashes.size());
+        }
+        return partner;
+    }
+
+    /**
+     * @brief Copy the collectors' current values into the result
+     */
+    void update_metric_results() {
+        result_.avalanche_score = avalanche_analyzer_->get_avalanche_score();
+        result_.avalanche_bias = avalanche_analyzer_->get_avalanche_bias();
+        if (avalanche_analyzer_->has_matrix()) {
+            result_.sac_bias = avalanche_analyzer_->get_sac_bias();
+            result_.bic_max_correlation = avalanche_analyzer_->get_bic_max_correlation();
+            result_.sac_collected = true;
+        }
+        result_.chi_squared = chi_squared_calc_->get_chi_squared();
+        result_.uniformity_score = chi_squared_calc_->get_uniformity_score();
+        result_.collision_ratio = collision_analyzer_->get_collision_ratio();
+        result_.actual_collisions = collision_analyzer_->get_actual_collisions();
+        result_.expected_collisions = collision_analyzer_->get_expected_collisions();
+        result_.load_factor = collision_analyzer_->get_load_factor();
+        result_.metrics_collected = true;
+    }
+
+public:
+    /**
+     * @brief Runs the performance benchmark on the calling thread
      */
     void run_performance_benchmark() {
         if (!test_data_) {
             throw std::runtime_error("Test data is not initialized");
         }
-        performance_thread = std::make_unique<std::thread>([this]() {
-            size_t total_bytes = 0;
-            size_t num_hashes = 0;
-            size_t num_tests = std::min<size_t>(1000000, test_data_->size());
-            size_t warmup = std::min<size_t>(1000, num_tests);
+        size_t total_bytes = 0;
+        size_t num_hashes = 0;
+        size_t num_tests = std::min<size_t>(1000000, test_data_->size());
+        size_t warmup = std::min<size_t>(1000, num_tests);
+        // Folding every hash into a checksum keeps the compiler from dropping the calls
+        uint64_t checksum = 0;
+        HashFunction hash_function = algorithm_.make(result_.table_size, hasher_);
+        std::unique_ptr<PerfCounters> counters;
+        if (perf_counters_) {
+            counters = std::make_unique<PerfCounters>();
+        }
+        std::chrono::high_resolution_clock::time_point start, end;
+        // The algorithm is resolved once, outside the timed loop
+        std::visit([&](auto& hash_fn) {
             // Warm up
             for (size_t i = 0; i < warmup; ++i) {
-                std::string data_str = test_data_->get_test(i);
-                std::vector<uint8_t> data(data_str.begin(), data_str.end());
-                compute_hash(result_.algorithm, data.data(), data.size(), result_.table_size, hasher_);
+                std::span<const uint8_t> data = test_data_->get_view(i);
+                checksum ^= hash_fn(data.data(), data.size());
             }
             // Benchmark
-            auto start = std::chrono::high_resolution_clock::now();
+            if (counters) counters->start();
+            start = std::chrono::high_resolution_clock::now();
             for (size_t i = 0; i < num_tests; ++i) {
-                std::string data_str = test_data_->get_test(i);
-                total_bytes += data_str.size();
-                std::vector<uint8_t> data(data_str.begin(), data_str.end());
-                compute_hash(result_.algorithm, data.data(), data.size(), result_.table_size, hasher_);
+                std::span<const uint8_t> data = test_data_->get_view(i);
+                total_bytes += data.size();
+                checksum ^= hash_fn(data.data(), data.size());
                 num_hashes++;
             }
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+            end = std::chrono::high_resolution_clock::now();
+            if (counters) {
+                result_.perf = counters->stop(num_hashes);
+                result_.perf_collected = true;
+            }
+        }, hash_function);
+        benchmark_checksum_ = checksum;
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        result_.ns_per_hash = static_cast<double>(duration) / num_hashes;
+        result_.throughput_mbs = (total_bytes / (1024.0 * 1024.0)) / (duration / 1e9);
+        result_.total_time_ms = static_cast<double>(duration) / 1e6;
+        performance_benchmark_complete_.store(true);
+    }
+
+    /**
+     * @brief Benchmark and collect metrics over keys as they are generated
+     * @details Replaces run_performance_benchmark() and run_metrics_collection()
+     * for a runner constructed without test data. Every batch is hashed in a
+     * timed loop and then, with metrics enabled, fed into the collectors before
+     * it goes back to the generator, so neither the corpus nor its size in
+     * memory is needed. Unlike the stored-data benchmark, every key of the
+     * stream is timed. Collision records need the inputs of earlier keys and
+     * are not available.
+     * @param stream Keys of this runner; consumed on the calling thread
+     */
+    void run_stream(TestStream& stream) {
+        if (store_collisions_) {
+            throw std::runtime_error("Collision records need stored test data and cannot be streamed");
+        }
+        uint64_t total_bytes = 0;
+        uint64_t num_hashes = 0;
+        uint64_t duration = 0;
+        uint64_t checksum = 0;
+        MetricsScratch scratch;
+        HashFunction hash_function = algorithm_.make(result_.table_size, hasher_);
+        HashFunction full_hash_function = algorithm_.make(FULL_HASH, hasher_);
+        std::unique_ptr<PerfCounters> counters;
+        if (perf_counters_) {
+            counters = std::make_unique<PerfCounters>();
+        }
+        std::visit([&](auto& hash_fn) {
+            using Fn = std::decay_t<decltype(hash_fn)>;
+            Fn* full_hash_fn = analyze_64bit_ ? &std::get<Fn>(full_hash_function) : nullptr;
+            stream.for_each_batch([&](const TestBatch& batch, size_t first) {
+                // Benchmark
+                if (counters) counters->start();
+                auto start = std::chrono::high_resolution_clock::now();
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    std::span<const uint8_t> data = batch.view(i);
+                    total_bytes += data.size();
+                    checksum ^= hash_fn(data.data(), data.size());
+                }
+                auto end = std::chrono::high_resolution_clock::now();
+                if (counters) {
+                    PerfSample sample = counters->stop(batch.size());
+                    if (result_.perf_collected) {
+                        result_.perf.merge(sample);
+                    } else {
+                        result_.perf = sample;
+                        result_.perf_collected = true;
+                    }
+                }
+                duration += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+                num_hashes += batch.size();
+
+                if (collect_metrics_) {
+                    for (size_t i = 0; i < batch.size(); ++i) {
+                        uint64_t hash = 0;
+                        collect_key_metrics(hash_fn, full_hash_fn, batch.view(i), first + i, hash, scratch);
+                    }
+                }
+            });
+        }, hash_function);
+        flush_full_hashes(scratch);
+        benchmark_checksum_ = checksum;
+        if (num_hashes > 0 && duration > 0) {
             result_.ns_per_hash = static_cast<double>(duration) / num_hashes;
             result_.throughput_mbs = (total_bytes / (1024.0 * 1024.0)) / (duration / 1e9);
-            result_.total_time_ms = static_cast<double>(duration) / 1e6;
-            performance_benchmark_complete_.store(true);
-            performance_benchmark_complete_.notify_all();
-        });
-        performance_thread->detach();
+        }
+        result_.total_time_ms = static_cast<double>(duration) / 1e6;
+        if (collect_metrics_) {
+            update_metric_results();
+            metrics_collection_complete_.store(true);
+        }
+        performance_benchmark_complete_.store(true);
     }
     
 };
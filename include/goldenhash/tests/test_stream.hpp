@@ -0,0 +1,120 @@
+#pragma once
+
+#include "spsc_queue.hpp"
+#include "test_data.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace goldenhash::tests {
+
+/**
+ * @brief Test keys of one partition, generated while they are being consumed
+ *
+ * A generator thread fills TestBatch buffers with the keys of
+ * create_test_data() and passes them to the consumer through an SPSC ring;
+ * the consumer hands every buffer back through a second ring once it is done
+ * with it. Only RING_BATCHES buffers ever exist, so the memory in use does
+ * not depend on the number of keys, and generating the next batches overlaps
+ * with hashing the current one.
+ */
+class TestStream {
+public:
+    static constexpr size_t RING_BATCHES = 8;
+
+private:
+    std::vector<TestBatch> batches_;
+    SpscQueue<TestBatch*> filled_;  // Generator -> consumer
+    SpscQueue<TestBatch*> free_;    // Consumer -> generator
+    size_t start_index_;
+    size_t end_index_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> finished_{false};
+    std::exception_ptr error_;
+    std::thread generator_;
+
+    void generate(uint64_t seed) {
+        try {
+            TestKeyGenerator generator(seed);
+            for (size_t first = start_index_; first < end_index_; first += TestKeyGenerator::BATCH_KEYS) {
+                TestBatch* batch;
+                while (!free_.try_pop(batch)) {
+                    if (stopping_.load(std::memory_order_relaxed)) return;
+                    std::this_thread::yield();
+                }
+                batch->clear();
+                generator.generate(*batch, first, std::min(end_index_, first + TestKeyGenerator::BATCH_KEYS));
+                // Cannot fail, the ring has room for every buffer
+                filled_.try_push(batch);
+            }
+        } catch (...) {
+            error_ = std::current_exception();
+        }
+        finished_.store(true, std::memory_order_release);
+    }
+
+public:
+    /**
+     * @brief Start generating the keys with indices [start_index, end_index)
+     * @param seed Seed of the random keys; the same seed and range give the same keys
+     */
+    TestStream(size_t start_index, size_t end_index, uint64_t seed)
+        : batches_(RING_BATCHES), filled_(RING_BATCHES), free_(RING_BATCHES),
+          start_index_(start_index), end_index_(end_index) {
+        if (start_index > end_index) {
+            throw std::invalid_argument("start_index must not be greater than end_index");
+        }
+        for (TestBatch& batch : batches_) {
+            free_.try_push(&batch);
+        }
+        generator_ = std::thread(&TestStream::generate, this, seed);
+    }
+
+    TestStream(const TestStream&) = delete;
+    TestStream& operator=(const TestStream&) = delete;
+
+    ~TestStream() {
+        stopping_.store(true, std::memory_order_relaxed);
+        generator_.join();
+    }
+
+    /**
+     * @brief Number of keys in the stream
+     */
+    size_t size() const { return end_index_ - start_index_; }
+
+    /**
+     * @brief Pass every batch to fn in order, on the calling thread
+     * @details May be called once, from one thread. The batch is reused as soon as fn returns.
+     * @param fn Called as fn(const TestBatch& batch, size_t first) with first the
+     * stream index of the batch's first key
+     * @throws Whatever the generator threw
+     */
+    template <typename Fn>
+    void for_each_batch(Fn&& fn) {
+        size_t first = 0;
+        TestBatch* batch;
+        while (true) {
+            // Read the flag before popping so that an empty ring afterwards means the stream has ended
+            bool finished = finished_.load(std::memory_order_acquire);
+            if (filled_.try_pop(batch)) {
+                fn(static_cast<const TestBatch&>(*batch), first);
+                first += batch->size();
+                free_.try_push(batch);
+            } else if (finished) {
+                break;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+};
+
+} // namespace goldenhash::tests
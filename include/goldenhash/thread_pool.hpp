@@ -0,0 +1,312 @@
+/**
+ * Copyright 2025 Josh Morgan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file thread_pool.hpp
+ * @brief Work-stealing thread pool for parallel sweeps over independent items
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace goldenhash {
+
+/**
+ * @class ThreadPool
+ * @brief Persistent worker threads that run parallel_for() jobs with work stealing
+ *
+ * Each job is split into one contiguous block of indices per worker. A worker
+ * takes items from the back of its own block and, once that is empty, steals
+ * from the front of the other workers' blocks. Items of very different cost
+ * (e.g. candidate table sizes from 10K to 16M) therefore keep every worker busy
+ * until the whole job is done.
+ *
+ * Workers can be pinned to a list of CPUs, and run_on_workers() runs one task
+ * on each of the first workers without stealing, so long-running tasks stay on
+ * the core their worker is pinned to.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Item callback: item index in [0, count) and the index of the worker running it
+     */
+    using Task = std::function<void(size_t index, size_t worker)>;
+
+    /**
+     * @brief Start the worker threads
+     * @param num_threads Number of workers, 0 for one per hardware thread
+     */
+    explicit ThreadPool(size_t num_threads = 0) : ThreadPool(num_threads, {}) {}
+
+    /**
+     * @brief Start the worker threads, pinned to CPUs
+     * @param num_threads Number of workers, 0 for one per hardware thread
+     * @param cpus CPU of each worker, reused round-robin if there are fewer CPUs
+     * than workers; empty leaves placement to the scheduler
+     * @throws std::system_error if a worker cannot be pinned
+     */
+    ThreadPool(size_t num_threads, const std::vector<int>& cpus) : cpus_(cpus) {
+        if (num_threads == 0) {
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        queues_.reserve(num_threads);
+        for (size_t i = 0; i < num_threads; i++) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        workers_.reserve(num_threads);
+        for (size_t i = 0; i < num_threads; i++) {
+            workers_.emplace_back([this, i] { worker_loop(i); });
+        }
+        for (size_t i = 0; i < num_threads && !cpus_.empty(); i++) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu_of(i), &set);
+            int rc = pthread_setaffinity_np(workers_[i].native_handle(), sizeof(set), &set);
+            if (rc != 0) {
+                shutdown();
+                throw std::system_error(rc, std::generic_category(),
+                                        "Failed to pin worker to CPU " + std::to_string(cpu_of(i)));
+            }
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        shutdown();
+    }
+
+    /**
+     * @brief Number of worker threads
+     */
+    size_t size() const { return workers_.size(); }
+
+    /**
+     * @brief CPU a worker is pinned to, or -1 if the pool is not pinned
+     */
+    int cpu_of(size_t worker) const {
+        return cpus_.empty() ? -1 : cpus_[worker % cpus_.size()];
+    }
+
+    /**
+     * @brief Parse a CPU list such as "0-3,8,10-11"
+     * @param list Comma-separated CPU numbers and inclusive ranges
+     * @return CPUs in the order given
+     * @throws std::invalid_argument if the list is malformed or names an impossible CPU
+     */
+    static std::vector<int> parse_cpu_list(const std::string& list) {
+        std::vector<int> cpus;
+        size_t pos = 0;
+        while (pos <= list.size()) {
+            size_t comma = list.find(',', pos);
+            std::string item = list.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            size_t dash = item.find('-');
+            int first, last;
+            try {
+                size_t used = 0;
+                first = std::stoi(item.substr(0, dash), &used);
+                if (used != (dash == std::string::npos ? item.size() : dash)) throw std::invalid_argument(item);
+                last = first;
+                if (dash != std::string::npos) {
+                    std::string tail = item.substr(dash + 1);
+                    last = std::stoi(tail, &used);
+                    if (used != tail.size()) throw std::invalid_argument(item);
+                }
+            } catch (const std::logic_error&) {
+                throw std::invalid_argument("Invalid CPU list entry '" + item + "' in '" + list + "'");
+            }
+            if (first < 0 || last < first || last >= CPU_SETSIZE) {
+                throw std::invalid_argument("Invalid CPU range '" + item + "' in '" + list + "'");
+            }
+            for (int cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+            if (comma == std::string::npos) break;
+            pos = comma + 1;
+        }
+        return cpus;
+    }
+
+    /**
+     * @brief Run task(worker) once on each of the workers 0 .. count - 1 and wait for them
+     * @details Unlike parallel_for() nothing is stolen, so each call runs on its
+     * own worker (and on that worker's CPU when the pool is pinned). Exceptions
+     * are handled as in parallel_for().
+     * @param count Number of workers to use, at most size()
+     * @param task Callback receiving the worker index
+     */
+    void run_on_workers(size_t count, const std::function<void(size_t worker)>& task) {
+        if (count > workers_.size()) {
+            throw std::invalid_argument("run_on_workers() needs " + std::to_string(count) +
+                                        " workers, the pool has " + std::to_string(workers_.size()));
+        }
+        run_job(count, [&](size_t, size_t worker) { task(worker); }, false);
+    }
+
+    /**
+     * @brief Run task(i, worker) for every i in [0, count) and wait for all of them
+     * @details The first exception thrown by a task is rethrown here once the
+     * remaining items have finished. Must not be called from inside a task.
+     * @param count Number of items
+     * @param task Callback for one item
+     */
+    void parallel_for(size_t count, const Task& task) {
+        run_job(count, task, true);
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> items;
+    };
+
+    /**
+     * @brief Hand out items [0, count) in per-worker blocks and wait for the job
+     * @param steal Whether idle workers take items from other workers' blocks;
+     * without stealing, count must not exceed the number of workers and item i
+     * runs on worker i
+     */
+    void run_job(size_t count, const Task& task, bool steal) {
+        if (count == 0) return;
+        std::unique_lock<std::mutex> lock(mutex_);
+        // Contiguous blocks keep neighbouring items, which tend to cost the same, on one worker
+        size_t per_worker = steal ? count / queues_.size() : 0;
+        size_t remainder = steal ? count % queues_.size() : count;
+        size_t next = 0;
+        for (size_t w = 0; w < queues_.size(); w++) {
+            size_t block = per_worker + (w < remainder ? 1 : 0);
+            std::lock_guard<std::mutex> queue_lock(queues_[w]->mutex);
+            for (size_t i = 0; i < block; i++) {
+                queues_[w]->items.push_back(next++);
+            }
+        }
+        task_ = &task;
+        steal_ = steal;
+        remaining_ = count;
+        error_ = nullptr;
+        generation_++;
+        wake_.notify_all();
+        // Wait for the workers to leave the job too, so none of them can pick up
+        // an item of the next job with this task
+        done_.wait(lock, [this] { return remaining_ == 0 && active_ == 0; });
+        task_ = nullptr;
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            if (worker.joinable()) worker.join();
+        }
+    }
+
+    /**
+     * @brief Take the next item, from the own queue first and then from the others
+     * @param worker Index of the calling worker
+     * @param index Receives the item index
+     * @return False once every queue is empty
+     */
+    bool next_item(size_t worker, size_t& index) {
+        {
+            Queue& own = *queues_[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.items.empty()) {
+                index = own.items.back();
+                own.items.pop_back();
+                return true;
+            }
+        }
+        if (!steal_) return false;
+        for (size_t k = 1; k < queues_.size(); k++) {
+            Queue& victim = *queues_[(worker + k) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.items.empty()) {
+                index = victim.items.front();
+                victim.items.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void worker_loop(size_t worker) {
+        size_t seen_generation = 0;
+        while (true) {
+            const Task* task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || (task_ && generation_ != seen_generation); });
+                if (stop_) return;
+                seen_generation = generation_;
+                task = task_;
+                active_++;
+            }
+            size_t index;
+            while (next_item(worker, index)) {
+                try {
+                    (*task)(index, worker);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!error_) error_ = std::current_exception();
+                }
+                std::lock_guard<std::mutex> lock(mutex_);
+                remaining_--;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--active_ == 0 && remaining_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+
+    std::vector<int> cpus_;
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const Task* task_ = nullptr;
+    bool steal_ = true;
+    size_t remaining_ = 0;
+    size_t active_ = 0;
+    size_t generation_ = 0;
+    std::exception_ptr error_;
+    bool stop_ = false;
+};
+
+} // namespace goldenhash
@@ -4,6 +4,7 @@ Comprehensive analysis of modular hash data
 """
 
 import sqlite3
+import sys
 import numpy as np
 import matplotlib.pyplot as plt
 import seaborn as sns
@@ -23,19 +24,48 @@ def is_prime(n):
             return False
     return True
 
-def analyze_modular_data(db_path="modular_hash_data.db"):
-    conn = sqlite3.connect(db_path)
-    
-    # Get all data
-    cursor = conn.execute("""
-        SELECT table_size, is_prime, avalanche_score, chi_square, collision_ratio,
-               unique_hashes, total_collisions, expected_collisions,
-               prime_high, prime_low, working_modulus
+# Columns in the order the analysis indexes its rows
+RESULT_COLUMNS = ["table_size", "is_prime", "avalanche_score", "chi_square", "collision_ratio",
+                  "unique_hashes", "total_collisions", "expected_collisions",
+                  "prime_high", "prime_low", "working_modulus"]
+
+# Record layout of goldenhash_test --sweep-out (BinarySweepSink in sweep.hpp)
+SWEEP_MAGIC = b"GHSWEEP\0"
+SWEEP_HEADER = np.dtype([("magic", "S8"), ("version", "<u4"), ("record_size", "<u4")])
+SWEEP_RECORD = np.dtype([
+    ("table_size", "<u8"), ("is_prime", "<u8"), ("prime_high", "<u8"), ("prime_low", "<u8"),
+    ("working_modulus", "<u8"), ("num_tests", "<u8"), ("unique_hashes", "<u8"),
+    ("total_collisions", "<u8"), ("max_bucket_load", "<u8"), ("test_hash", "<u8"),
+    ("expected_collisions", "<f8"), ("collision_ratio", "<f8"), ("chi_square", "<f8"),
+    ("avalanche_score", "<f8"), ("performance_ns", "<f8"),
+])
+
+def load_sweep_file(path):
+    """Map a --sweep-out results file as a numpy record array, without parsing rows"""
+    header = np.fromfile(path, dtype=SWEEP_HEADER, count=1)
+    if (len(header) != 1 or header["magic"][0] != SWEEP_MAGIC.rstrip(b"\0")
+            or header["version"][0] != 1 or header["record_size"][0] != SWEEP_RECORD.itemsize):
+        raise ValueError(f"{path} is not a version 1 sweep results file")
+    return np.memmap(path, dtype=SWEEP_RECORD, mode="r", offset=SWEEP_HEADER.itemsize)
+
+def load_results(path):
+    """Rows of RESULT_COLUMNS sorted by table size, from a sweep file or a SQLite database"""
+    if path.endswith(".bin"):
+        records = np.sort(load_sweep_file(path), order="table_size")
+        return list(zip(*(records[column].tolist() for column in RESULT_COLUMNS)))
+    conn = sqlite3.connect(path)
+    cursor = conn.execute(f"""
+        SELECT {", ".join(RESULT_COLUMNS)}
         FROM modular_hash_results
         ORDER BY table_size
     """)
-    
     data = cursor.fetchall()
+    conn.close()
+    return data
+
+def analyze_modular_data(db_path="modular_hash_data.db"):
+    # Get all data
+    data = load_results(db_path)
     
     # Separate by prime/composite
     prime_data = []
@@ -139,8 +169,6 @@ def analyze_modular_data(db_path="modular_hash_data.db"):
     
     # Create visualizations
     create_plots(data, prime_data, composite_data)
-    
-    conn.close()
 
 def create_plots(data, prime_data, composite_data):
     """Create visualization plots"""
@@ -228,4 +256,5 @@ def create_plots(data, prime_data, composite_data):
     print("\nAnalysis plots saved to goldenhash_analysis.png")
 
 if __name__ == "__main__":
-    analyze_modular_data()
\ No newline at end of file
+    # A .bin path is a goldenhash_test --sweep-out file, anything else a SQLite database
+    analyze_modular_data(sys.argv[1] if len(sys.argv) > 1 else "modular_hash_data.db")
\ No newline at end of file
@@ -19,6 +19,8 @@ def calculate_tests_for_collisions(n, target_collisions=10):
     Where n = number of tests, m = table size
     
     Approximation: for small collision rates, we need about sqrt(2*m*target_collisions)
+    
+    goldenhash_test --target-collisions uses the same estimate for each N of a sweep.
     """
     # For more accurate calculation, use iterative approach
     if target_collisions >= n:
@@ -77,33 +79,28 @@ class ModularDataCollector:
         conn.commit()
         conn.close()
     
-    def run_test(self, table_size, num_tests):
-        """Run modulo_rotate and capture results"""
-        cmd = ["../build/goldenhash_test", str(table_size), str(num_tests), "--json"]
+    def run_sweep(self, start_n, end_n, target_collisions=10):
+        """Run one in-process sweep over [start_n, end_n] and yield each result as it completes"""
+        cmd = ["../build/goldenhash_test", "--sweep", f"{start_n}:{end_n}",
+               "--target-collisions", str(target_collisions)]
         
-        try:
-            result = subprocess.run(cmd, capture_output=True, text=True, timeout=300)
-            if result.returncode == 0 and result.stdout:
-                return json.loads(result.stdout)
-            else:
-                print(f"Error running test for N={table_size}: {result.stderr}")
+        with subprocess.Popen(cmd, stdout=subprocess.PIPE, text=True) as proc:
+            for line in proc.stdout:
+                try:
+                    yield json.loads(line)
+                except json.JSONDecodeError as e:
+                    print(f"JSON parse error: {e}")
+                    print(f"Output was: {line}")
+                    proc.kill()
+                    return
+            proc.wait()
+            if proc.returncode != 0:
+                print(f"Sweep failed with exit code {proc.returncode}")
                 print(f"Command was: {' '.join(cmd)}")
-                print(f"Output was: {result.stdout}")
-                return None
-        except subprocess.TimeoutExpired:
-            print(f"Timeout for N={table_size}")
-            return None
-        except json.JSONDecodeError as e:
-            print(f"JSON parse error for N={table_size}: {e}")
-            print(f"Output was: {result.stdout}")
-            return None
-        except Exception as e:
-            print(f"Unexpected error for N={table_size}: {e}")
-            return None
-    
-    def save_result(self, data):
+                sys.exit(1)
+    
+    def save_result(self, conn, data):
         """Save test result to database"""
-        conn = sqlite3.connect(self.db_path)
         
         # Handle is_prime field (might be string "true"/"false" or boolean)
         is_prime = data.get("is_prime", False)
@@ -135,20 +132,17 @@ class ModularDataCollector:
             data["performance_ns_per_hash"],
             data["factors"]
         ))
-        
-        conn.commit()
-        conn.close()
     
-    def table_size_exists(self, table_size):
-        """Check if we already have data for this table size"""
+    def existing_table_sizes(self, start_n, end_n):
+        """Table sizes in [start_n, end_n] that already have data"""
         conn = sqlite3.connect(self.db_path)
         cursor = conn.execute(
-            "SELECT COUNT(*) FROM modular_hash_results WHERE table_size = ?",
-            (table_size,)
+            "SELECT DISTINCT table_size FROM modular_hash_results WHERE table_size BETWEEN ? AND ?",
+            (start_n, end_n)
         )
-        count = cursor.fetchone()[0]
+        sizes = {row[0] for row in cursor}
         conn.close()
-        return count > 0
+        return sizes
 
 def main():
     print("Modular Hash Data Collection")
@@ -183,34 +177,29 @@ def main():
     # The golden ratio
     GOLDEN_RATIO = (1 + math.sqrt(5)) / 2
     
-    # Test each N
-    #for n in range(start_n, end_n + 6):
-    for num in tqdm.tqdm(range(start_n, end_n), unit="N"):
-        # n = (num * 6) + 1679616
-        n = num + 67536 + 65535
-        # Skip if already exists (for resume functionality)
-        if collector.table_size_exists(n):
-            skipped += 1
-            continue
-        
-        # Calculate tests needed for ~10 collisions
-        num_tests = calculate_tests_for_collisions(n, target_collisions=10)
-        
-        # Run test
-        test_start = time.time()
-        result = collector.run_test(n, num_tests)
-        test_time = time.time() - test_start
-        
-        if result is None:
-            # Exit if the test failed
-            print(f"Failed to run test for N={n}, exiting.")
-            sys.exit(1)
-
-        if result:
-            collector.save_result(result)
+    # Test each N in one process; the sweep reuses its generated keys for every N
+    first_n = start_n + 67536 + 65535
+    last_n = end_n - 1 + 67536 + 65535
+    existing = collector.existing_table_sizes(first_n, last_n)
+    skipped = len(existing)
+    # Resume at the first size without data
+    while first_n <= last_n and first_n in existing:
+        first_n += 1
+    
+    if first_n <= last_n:
+        conn = sqlite3.connect(collector.db_path)
+        progress = tqdm.tqdm(total=last_n - first_n + 1, unit="N")
+        for result in collector.run_sweep(first_n, last_n, target_collisions=10):
+            progress.update(1)
+            if result["table_size"] in existing:
+                continue
+            collector.save_result(conn, result)
             completed += 1
-        else:
-            print(f" ✗ ({test_time:.1f}s)")
+            if completed % 1000 == 0:
+                conn.commit()
+        conn.commit()
+        conn.close()
+        progress.close()
     
     # Final summary
     total_time = time.time() - start_time
@@ -21,64 +21,828 @@
  */
 
 #include "goldenhash.hpp"
+#include "goldenhash/thread_pool.hpp"
+
+#include <atomic>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <mutex>
+#include <tuple>
 
 namespace goldenhash {
 
+namespace {
+
+/**
+ * @brief Word index at which hash() re-derives the S-box selector
+ * @details hash() walks 32-byte strides first and restarts the selector from
+ * the current state before the remaining words and bytes.
+ * @param len Key length in bytes
+ * @return Word index of the restart, or SIZE_MAX if there is none
+ */
+inline size_t stride_resync_word(size_t len) {
+    return len >= 32 ? (len / 32) * 4 : SIZE_MAX;
+}
+
+/**
+ * @brief Length term hash() folds into the final avalanche
+ * @param len Key length in bytes
+ * @return Length left over after the 32-byte stride loop
+ */
+inline size_t final_length(size_t len) {
+    return len >= 32 ? len % 32 : len;
+}
+
+#ifdef HAS_AVX2
+
+/**
+ * @brief Load the next trailing byte of every lane
+ */
+template <size_t Lanes>
+inline void load_lane_bytes(const uint8_t* const* data, size_t i, uint64_t* out) {
+    for (size_t l = 0; l < Lanes; l++) {
+        out[l] = data[l][i];
+    }
+}
+
+// GCC 12 reports the undefined pass-through operand of the unmasked 512-bit
+// shift and gather intrinsics under -Wuninitialized; the zero-masked forms
+// compile to the same instructions without the false positive.
+constexpr __mmask8 ALL_LANES = 0xFF;
+
+__attribute__((target("avx512f")))
+inline __m512i shl_avx512(__m512i a, unsigned int n) {
+    return _mm512_maskz_slli_epi64(ALL_LANES, a, n);
+}
+
+__attribute__((target("avx512f")))
+inline __m512i shr_avx512(__m512i a, unsigned int n) {
+    return _mm512_maskz_srli_epi64(ALL_LANES, a, n);
+}
+
+__attribute__((target("avx512f")))
+inline __m512i gather_avx512(__m512i offsets, const void* base) {
+    return _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), ALL_LANES, offsets, base, 1);
+}
+
+/**
+ * @brief Byte offset of the S-box each lane reads in a given lookup slot
+ * @param c Instance constants
+ * @param sel Per-lane selector before the lookup sequence
+ * @param slot Lookups already issued since the selector was taken
+ */
+__attribute__((target("avx512f")))
+inline __m512i sbox_offset_avx512(const detail::MixConstants& c, __m512i sel, uint64_t slot) {
+    __m512i k = _mm512_add_epi64(sel, _mm512_set1_epi64(slot + 1));
+    return _mm512_maskz_sllv_epi64(ALL_LANES, _mm512_and_si512(k, _mm512_set1_epi64(c.sbox_mask)),
+                                   _mm512_set1_epi64(c.index_bits));
+}
+
+/**
+ * @brief One S-box lookup in each of the 8 lanes
+ */
+__attribute__((target("avx512f")))
+inline __m512i sbox_lookup_avx512(const detail::MixConstants& c, __m512i offset, __m512i field) {
+    __m512i idx = _mm512_add_epi64(offset, _mm512_and_si512(field, _mm512_set1_epi64(c.index_mask)));
+    return _mm512_and_si512(gather_avx512(idx, c.sboxes), _mm512_set1_epi64(0xFF));
+}
+
+/**
+ * @brief AVX-512 lane kernel: one 64-bit lane of a zmm register per key
+ * @param c Instance constants
+ * @param data The 8 keys
+ * @param len Length shared by the keys
+ * @param out Full 64-bit hash value of each lane
+ */
+__attribute__((target("avx512f,avx512dq")))
+void mix_lanes_avx512(const detail::MixConstants& c, const uint8_t* const* data, size_t len, uint64_t* out) {
+    const __m512i plow = _mm512_set1_epi64(c.prime_low);
+    const __m512i phigh = _mm512_set1_epi64(c.prime_high);
+    const __m512i ptrs = _mm512_loadu_si512(data);
+    __m512i h = _mm512_set1_epi64(c.initial_hash);
+    __m512i state = _mm512_set1_epi64(c.initial_state);
+    __m512i sel = _mm512_set1_epi64(~c.initial_state);
+
+    size_t words = len / 8;
+    size_t resync = stride_resync_word(len);
+    __m512i off[8];
+    for (size_t k = 0; k < 8; k++) {
+        off[k] = sbox_offset_avx512(c, sel, k);
+    }
+    for (size_t w = 0; w < words; w++) {
+        if (w == resync) {
+            // Each lane restarts from its own state; a word advances the
+            // selector by a full turn, so the offsets hold until the tail.
+            sel = _mm512_xor_si512(state, _mm512_set1_epi64(-1));
+            for (size_t k = 0; k < 8; k++) {
+                off[k] = sbox_offset_avx512(c, sel, k);
+            }
+        }
+        __m512i chunk = gather_avx512(_mm512_add_epi64(ptrs, _mm512_set1_epi64(w * 8)), nullptr);
+        state = _mm512_xor_si512(state, chunk);
+        state = _mm512_mullo_epi64(state, plow);
+        state = _mm512_xor_si512(state, shr_avx512(state, 17));
+        __m512i mixed = _mm512_xor_si512(state, h);
+        __m512i comp = shl_avx512(sbox_lookup_avx512(c, off[0], mixed), 56);
+        comp = _mm512_or_si512(comp, shl_avx512(sbox_lookup_avx512(c, off[1], shr_avx512(mixed, 12)), 48));
+        comp = _mm512_or_si512(comp, shl_avx512(sbox_lookup_avx512(c, off[2], shr_avx512(mixed, 24)), 40));
+        comp = _mm512_or_si512(comp, shl_avx512(sbox_lookup_avx512(c, off[3], shr_avx512(mixed, 36)), 32));
+        comp = _mm512_or_si512(comp, shl_avx512(sbox_lookup_avx512(c, off[4], shr_avx512(mixed, 48)), 24));
+        mixed = _mm512_xor_si512(shl_avx512(state, 13), shr_avx512(h, 7));
+        comp = _mm512_or_si512(comp, shl_avx512(sbox_lookup_avx512(c, off[5], mixed), 16));
+        comp = _mm512_or_si512(comp, shl_avx512(sbox_lookup_avx512(c, off[6], shr_avx512(mixed, 12)), 8));
+        comp = _mm512_or_si512(comp, sbox_lookup_avx512(c, off[7], shr_avx512(mixed, 24)));
+        h = _mm512_xor_si512(h, comp);
+        h = _mm512_mullo_epi64(h, phigh);
+        h = _mm512_xor_si512(h, shr_avx512(h, 29));
+    }
+    if (resync == words) {
+        sel = _mm512_xor_si512(state, _mm512_set1_epi64(-1));
+    }
+
+    alignas(64) uint64_t bytes[8];
+    for (size_t i = words * 8; i < len; i++) {
+        load_lane_bytes<8>(data, i, bytes);
+        state = _mm512_or_si512(shl_avx512(state, 8), _mm512_load_si512(bytes));
+        state = _mm512_mullo_epi64(state, plow);
+        state = _mm512_xor_si512(state, shr_avx512(state, 17));
+        __m512i c1 = sbox_lookup_avx512(c, sbox_offset_avx512(c, sel, 0), _mm512_xor_si512(state, h));
+        __m512i c2 = sbox_lookup_avx512(c, sbox_offset_avx512(c, sel, 1),
+                                        _mm512_xor_si512(shr_avx512(state, 12), shr_avx512(h, 6)));
+        __m512i c3 = sbox_lookup_avx512(c, sbox_offset_avx512(c, sel, 2),
+                                        _mm512_xor_si512(shr_avx512(state, 24), shr_avx512(h, 18)));
+        sel = _mm512_add_epi64(sel, _mm512_set1_epi64(3));
+        h = _mm512_or_si512(shl_avx512(h, 24), shl_avx512(c1, 16));
+        h = _mm512_or_si512(h, _mm512_or_si512(shl_avx512(c2, 8), c3));
+        h = _mm512_xor_si512(h, state);
+        h = _mm512_mullo_epi64(h, phigh);
+        h = _mm512_xor_si512(h, shr_avx512(h, 29));
+    }
+
+    // Final avalanche
+    h = _mm512_xor_si512(h, _mm512_set1_epi64(final_length(len) * c.prime_mixed));
+    h = _mm512_xor_si512(h, shr_avx512(h, 33));
+    h = _mm512_mullo_epi64(h, plow);
+    h = _mm512_xor_si512(h, shr_avx512(h, 27));
+    _mm512_storeu_si512(out, h);
+}
+
+/**
+ * @brief Low 64 bits of a lane-wise 64x64-bit product (AVX2 has no vpmullq)
+ */
+__attribute__((target("avx2")))
+inline __m256i mullo_epi64_avx2(__m256i a, __m256i b) {
+    __m256i lo = _mm256_mul_epu32(a, b);
+    __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                                     _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+
+/**
+ * @brief Byte offset of the S-box each lane reads in a given lookup slot
+ * @param c Instance constants
+ * @param sel Per-lane selector before the lookup sequence
+ * @param slot Lookups already issued since the selector was taken
+ */
+__attribute__((target("avx2")))
+inline __m256i sbox_offset_avx2(const detail::MixConstants& c, __m256i sel, uint64_t slot) {
+    __m256i k = _mm256_add_epi64(sel, _mm256_set1_epi64x(slot + 1));
+    return _mm256_sllv_epi64(_mm256_and_si256(k, _mm256_set1_epi64x(c.sbox_mask)),
+                             _mm256_set1_epi64x(c.index_bits));
+}
+
+/**
+ * @brief One S-box lookup in each of the 8 lanes held as two 4-lane halves
+ * @details Both halves' indices are packed into the dwords of one register so a
+ * single 8-wide gather serves all lanes.
+ */
+__attribute__((target("avx2")))
+inline void sbox_lookup_avx2(const detail::MixConstants& c, const __m256i* offset, __m256i field_a,
+                             __m256i field_b, __m256i& out_a, __m256i& out_b) {
+    const __m256i index_mask = _mm256_set1_epi64x(c.index_mask);
+    const __m256i mask8 = _mm256_set1_epi64x(0xFF);
+    __m256i idx_a = _mm256_add_epi64(offset[0], _mm256_and_si256(field_a, index_mask));
+    __m256i idx_b = _mm256_add_epi64(offset[1], _mm256_and_si256(field_b, index_mask));
+    __m256i idx = _mm256_or_si256(idx_a, _mm256_slli_epi64(idx_b, 32));
+    __m256i r = _mm256_i32gather_epi32(reinterpret_cast<const int*>(c.sboxes), idx, 1);
+    out_a = _mm256_and_si256(r, mask8);
+    out_b = _mm256_and_si256(_mm256_srli_epi64(r, 32), mask8);
+}
+
+/**
+ * @brief AVX2 lane kernel: 8 keys as two ymm registers of 4 lanes each
+ * @param c Instance constants
+ * @param data The 8 keys
+ * @param len Length shared by the keys
+ * @param out Full 64-bit hash value of each lane
+ */
+__attribute__((target("avx2")))
+void mix_lanes_avx2(const detail::MixConstants& c, const uint8_t* const* data, size_t len, uint64_t* out) {
+    const __m256i plow = _mm256_set1_epi64x(c.prime_low);
+    const __m256i phigh = _mm256_set1_epi64x(c.prime_high);
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    __m256i ptrs[2] = {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)),
+                       _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 4))};
+    __m256i h[2], state[2], sel[2];
+    for (size_t half = 0; half < 2; half++) {
+        h[half] = _mm256_set1_epi64x(c.initial_hash);
+        state[half] = _mm256_set1_epi64x(c.initial_state);
+        sel[half] = _mm256_set1_epi64x(~c.initial_state);
+    }
+
+    size_t words = len / 8;
+    size_t resync = stride_resync_word(len);
+    // off[k][half]: S-box offsets of lookup slot k
+    __m256i off[8][2];
+    for (size_t k = 0; k < 8; k++) {
+        off[k][0] = off[k][1] = sbox_offset_avx2(c, sel[0], k);
+    }
+    for (size_t w = 0; w < words; w++) {
+        if (w == resync) {
+            for (size_t half = 0; half < 2; half++) {
+                sel[half] = _mm256_xor_si256(state[half], ones);
+                for (size_t k = 0; k < 8; k++) {
+                    off[k][half] = sbox_offset_avx2(c, sel[half], k);
+                }
+            }
+        }
+        __m256i mixed[2], mixed2[2];
+        for (size_t half = 0; half < 2; half++) {
+            __m256i addr = _mm256_add_epi64(ptrs[half], _mm256_set1_epi64x(w * 8));
+            __m256i chunk = _mm256_i64gather_epi64(nullptr, addr, 1);
+            __m256i s = _mm256_xor_si256(state[half], chunk);
+            s = mullo_epi64_avx2(s, plow);
+            s = _mm256_xor_si256(s, _mm256_srli_epi64(s, 17));
+            state[half] = s;
+            mixed[half] = _mm256_xor_si256(s, h[half]);
+            mixed2[half] = _mm256_xor_si256(_mm256_slli_epi64(s, 13), _mm256_srli_epi64(h[half], 7));
+        }
+        __m256i comp[2], ca, cb;
+        sbox_lookup_avx2(c, off[0], mixed[0], mixed[1], ca, cb);
+        comp[0] = _mm256_slli_epi64(ca, 56);
+        comp[1] = _mm256_slli_epi64(cb, 56);
+        static constexpr int field_shift[4] = {12, 24, 36, 48};
+        static constexpr int out_shift[4] = {48, 40, 32, 24};
+        for (size_t k = 0; k < 4; k++) {
+            sbox_lookup_avx2(c, off[k + 1], _mm256_srli_epi64(mixed[0], field_shift[k]),
+                             _mm256_srli_epi64(mixed[1], field_shift[k]), ca, cb);
+            comp[0] = _mm256_or_si256(comp[0], _mm256_slli_epi64(ca, out_shift[k]));
+            comp[1] = _mm256_or_si256(comp[1], _mm256_slli_epi64(cb, out_shift[k]));
+        }
+        for (size_t k = 0; k < 3; k++) {
+            sbox_lookup_avx2(c, off[k + 5], _mm256_srli_epi64(mixed2[0], 12 * k),
+                             _mm256_srli_epi64(mixed2[1], 12 * k), ca, cb);
+            comp[0] = _mm256_or_si256(comp[0], _mm256_slli_epi64(ca, 16 - 8 * k));
+            comp[1] = _mm256_or_si256(comp[1], _mm256_slli_epi64(cb, 16 - 8 * k));
+        }
+        for (size_t half = 0; half < 2; half++) {
+            __m256i x = _mm256_xor_si256(h[half], comp[half]);
+            x = mullo_epi64_avx2(x, phigh);
+            h[half] = _mm256_xor_si256(x, _mm256_srli_epi64(x, 29));
+        }
+    }
+    if (resync == words) {
+        for (size_t half = 0; half < 2; half++) {
+            sel[half] = _mm256_xor_si256(state[half], ones);
+        }
+    }
+
+    alignas(32) uint64_t bytes[8];
+    for (size_t i = words * 8; i < len; i++) {
+        load_lane_bytes<8>(data, i, bytes);
+        __m256i field[3][2];
+        for (size_t half = 0; half < 2; half++) {
+            __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(bytes + half * 4));
+            __m256i s = _mm256_or_si256(_mm256_slli_epi64(state[half], 8), b);
+            s = mullo_epi64_avx2(s, plow);
+            s = _mm256_xor_si256(s, _mm256_srli_epi64(s, 17));
+            state[half] = s;
+            field[0][half] = _mm256_xor_si256(s, h[half]);
+            field[1][half] = _mm256_xor_si256(_mm256_srli_epi64(s, 12), _mm256_srli_epi64(h[half], 6));
+            field[2][half] = _mm256_xor_si256(_mm256_srli_epi64(s, 24), _mm256_srli_epi64(h[half], 18));
+        }
+        __m256i comp[3][2];
+        for (size_t k = 0; k < 3; k++) {
+            __m256i offset[2] = {sbox_offset_avx2(c, sel[0], k), sbox_offset_avx2(c, sel[1], k)};
+            sbox_lookup_avx2(c, offset, field[k][0], field[k][1], comp[k][0], comp[k][1]);
+        }
+        for (size_t half = 0; half < 2; half++) {
+            sel[half] = _mm256_add_epi64(sel[half], _mm256_set1_epi64x(3));
+            __m256i x = _mm256_or_si256(_mm256_slli_epi64(h[half], 24), _mm256_slli_epi64(comp[0][half], 16));
+            x = _mm256_or_si256(x, _mm256_or_si256(_mm256_slli_epi64(comp[1][half], 8), comp[2][half]));
+            x = _mm256_xor_si256(x, state[half]);
+            x = mullo_epi64_avx2(x, phigh);
+            h[half] = _mm256_xor_si256(x, _mm256_srli_epi64(x, 29));
+        }
+    }
+
+    // Final avalanche
+    const __m256i len_term = _mm256_set1_epi64x(final_length(len) * c.prime_mixed);
+    for (size_t half = 0; half < 2; half++) {
+        __m256i x = _mm256_xor_si256(h[half], len_term);
+        x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 33));
+        x = mullo_epi64_avx2(x, plow);
+        x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 27));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + half * 4), x);
+    }
+}
+
+/**
+ * @brief Best SIMD level supported by the running CPU
+ */
+SimdLevel detect_simd_level() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    return SimdLevel::Scalar;
+}
+
+/**
+ * @brief Level hash_batch() uses until set_simd_level() is called
+ */
+SimdLevel default_simd_level() {
+    return detect_simd_level();
+}
+
+#elif defined(HAS_NEON)
+
+/**
+ * @brief Low 64 bits of a lane-wise 64x64-bit product (NEON has no 64-bit vmul)
+ */
+inline uint64x2_t mullo_u64_neon(uint64x2_t a, uint64x2_t b) {
+    uint32x4_t cross = vmulq_u32(vreinterpretq_u32_u64(a), vrev64q_u32(vreinterpretq_u32_u64(b)));
+    uint64x2_t hi = vshlq_n_u64(vpaddlq_u32(cross), 32);
+    return vaddq_u64(vmull_u32(vmovn_u64(a), vmovn_u64(b)), hi);
+}
+
+/**
+ * @brief Byte offset of the S-box each lane reads in a given lookup slot
+ * @param c Instance constants
+ * @param sel Per-lane selector before the lookup sequence
+ * @param slot Lookups already issued since the selector was taken
+ */
+inline uint64x2_t sbox_offset_neon(const detail::MixConstants& c, uint64x2_t sel, uint64_t slot) {
+    uint64x2_t k = vaddq_u64(sel, vdupq_n_u64(slot + 1));
+    return vshlq_u64(vandq_u64(k, vdupq_n_u64(c.sbox_mask)), vdupq_n_s64(c.index_bits));
+}
+
+/**
+ * @brief Store the S-box byte offsets of one lookup slot for a lane pair
+ */
+inline void store_sbox_index_neon(const detail::MixConstants& c, uint64_t* idx, uint64x2_t offset,
+                                  uint64x2_t field) {
+    vst1q_u64(idx, vaddq_u64(offset, vandq_u64(field, vdupq_n_u64(c.index_mask))));
+}
+
+/**
+ * @brief NEON lane kernel: 8 keys as four q registers of 2 lanes each
+ * @details NEON has no gather and vqtbl4q_u8 only spans 64 bytes, so the
+ * S-box lookups stay scalar loads. The state, h and index arithmetic run
+ * two lanes per register, and each lane's looked-up bytes are written in the
+ * order that lets them be reloaded as the combined 64-bit word.
+ * @param c Instance constants
+ * @param data The 8 keys
+ * @param len Length shared by the keys
+ * @param out Full 64-bit hash value of each lane
+ */
+void mix_lanes_neon(const detail::MixConstants& c, const uint8_t* const* data, size_t len, uint64_t* out) {
+    constexpr size_t PAIRS = 4;
+    const uint64x2_t plow = vdupq_n_u64(c.prime_low);
+    const uint64x2_t phigh = vdupq_n_u64(c.prime_high);
+    uint64x2_t h[PAIRS], state[PAIRS], sel[PAIRS];
+    for (size_t p = 0; p < PAIRS; p++) {
+        h[p] = vdupq_n_u64(c.initial_hash);
+        state[p] = vdupq_n_u64(c.initial_state);
+        sel[p] = vdupq_n_u64(~c.initial_state);
+    }
+
+    alignas(16) uint64_t input[8];
+    alignas(16) uint64_t idx[8][8];     // idx[slot][lane]
+    alignas(16) uint8_t looked_up[8][8]; // looked_up[lane][byte of the combined word]
+
+    size_t words = len / 8;
+    size_t resync = stride_resync_word(len);
+    uint64x2_t off[8][PAIRS];
+    for (size_t k = 0; k < 8; k++) {
+        for (size_t p = 0; p < PAIRS; p++) {
+            off[k][p] = sbox_offset_neon(c, sel[p], k);
+        }
+    }
+    for (size_t w = 0; w < words; w++) {
+        if (w == resync) {
+            for (size_t p = 0; p < PAIRS; p++) {
+                sel[p] = veorq_u64(state[p], vdupq_n_u64(~uint64_t(0)));
+                for (size_t k = 0; k < 8; k++) {
+                    off[k][p] = sbox_offset_neon(c, sel[p], k);
+                }
+            }
+        }
+        for (size_t l = 0; l < 8; l++) {
+            input[l] = detail::load_word(data[l] + w * 8);
+        }
+        for (size_t p = 0; p < PAIRS; p++) {
+            uint64x2_t s = veorq_u64(state[p], vld1q_u64(input + 2 * p));
+            s = mullo_u64_neon(s, plow);
+            s = veorq_u64(s, vshrq_n_u64(s, 17));
+            state[p] = s;
+            uint64x2_t mixed = veorq_u64(s, h[p]);
+            store_sbox_index_neon(c, &idx[0][2 * p], off[0][p], mixed);
+            store_sbox_index_neon(c, &idx[1][2 * p], off[1][p], vshrq_n_u64(mixed, 12));
+            store_sbox_index_neon(c, &idx[2][2 * p], off[2][p], vshrq_n_u64(mixed, 24));
+            store_sbox_index_neon(c, &idx[3][2 * p], off[3][p], vshrq_n_u64(mixed, 36));
+            store_sbox_index_neon(c, &idx[4][2 * p], off[4][p], vshrq_n_u64(mixed, 48));
+            mixed = veorq_u64(vshlq_n_u64(s, 13), vshrq_n_u64(h[p], 7));
+            store_sbox_index_neon(c, &idx[5][2 * p], off[5][p], mixed);
+            store_sbox_index_neon(c, &idx[6][2 * p], off[6][p], vshrq_n_u64(mixed, 12));
+            store_sbox_index_neon(c, &idx[7][2 * p], off[7][p], vshrq_n_u64(mixed, 24));
+        }
+        // Lookup k lands in bits 63-8k of the combined word
+        for (size_t l = 0; l < 8; l++) {
+            for (size_t k = 0; k < 8; k++) {
+                looked_up[l][7 - k] = c.sboxes[idx[k][l]];
+            }
+        }
+        for (size_t p = 0; p < PAIRS; p++) {
+            uint64x2_t comp = vreinterpretq_u64_u8(vld1q_u8(looked_up[2 * p]));
+            uint64x2_t x = mullo_u64_neon(veorq_u64(h[p], comp), phigh);
+            h[p] = veorq_u64(x, vshrq_n_u64(x, 29));
+        }
+    }
+    if (resync == words) {
+        for (size_t p = 0; p < PAIRS; p++) {
+            sel[p] = veorq_u64(state[p], vdupq_n_u64(~uint64_t(0)));
+        }
+    }
+
+    std::memset(looked_up, 0, sizeof(looked_up));
+    for (size_t i = words * 8; i < len; i++) {
+        for (size_t l = 0; l < 8; l++) {
+            input[l] = data[l][i];
+        }
+        for (size_t p = 0; p < PAIRS; p++) {
+            uint64x2_t s = vorrq_u64(vshlq_n_u64(state[p], 8), vld1q_u64(input + 2 * p));
+            s = mullo_u64_neon(s, plow);
+            s = veorq_u64(s, vshrq_n_u64(s, 17));
+            state[p] = s;
+            store_sbox_index_neon(c, &idx[0][2 * p], sbox_offset_neon(c, sel[p], 0), veorq_u64(s, h[p]));
+            store_sbox_index_neon(c, &idx[1][2 * p], sbox_offset_neon(c, sel[p], 1),
+                                  veorq_u64(vshrq_n_u64(s, 12), vshrq_n_u64(h[p], 6)));
+            store_sbox_index_neon(c, &idx[2][2 * p], sbox_offset_neon(c, sel[p], 2),
+                                  veorq_u64(vshrq_n_u64(s, 24), vshrq_n_u64(h[p], 18)));
+            sel[p] = vaddq_u64(sel[p], vdupq_n_u64(3));
+        }
+        // The three lookups form bits 23-0 below the shifted h
+        for (size_t l = 0; l < 8; l++) {
+            looked_up[l][2] = c.sboxes[idx[0][l]];
+            looked_up[l][1] = c.sboxes[idx[1][l]];
+            looked_up[l][0] = c.sboxes[idx[2][l]];
+        }
+        for (size_t p = 0; p < PAIRS; p++) {
+            uint64x2_t comp = vreinterpretq_u64_u8(vld1q_u8(looked_up[2 * p]));
+            uint64x2_t x = veorq_u64(vorrq_u64(vshlq_n_u64(h[p], 24), comp), state[p]);
+            x = mullo_u64_neon(x, phigh);
+            h[p] = veorq_u64(x, vshrq_n_u64(x, 29));
+        }
+    }
+
+    // Final avalanche
+    const uint64x2_t len_term = vdupq_n_u64(final_length(len) * c.prime_mixed);
+    for (size_t p = 0; p < PAIRS; p++) {
+        uint64x2_t x = veorq_u64(h[p], len_term);
+        x = veorq_u64(x, vshrq_n_u64(x, 33));
+        x = mullo_u64_neon(x, plow);
+        x = veorq_u64(x, vshrq_n_u64(x, 27));
+        vst1q_u64(out + 2 * p, x);
+    }
+}
+
+SimdLevel detect_simd_level() {
+    // Advanced SIMD is mandatory on AArch64
+    return SimdLevel::NEON;
+}
+
+SimdLevel default_simd_level() {
+    // Without a gather every S-box index makes a round trip through memory, so
+    // the interleaved scalar lanes stay the default; select NEON explicitly
+    // where it measures faster.
+    return SimdLevel::Scalar;
+}
+
+#else
+
+SimdLevel detect_simd_level() {
+    return SimdLevel::Scalar;
+}
+
+SimdLevel default_simd_level() {
+    return SimdLevel::Scalar;
+}
+
+#endif // HAS_AVX2
+
+/**
+ * @brief Find a non-trivial factor of an odd composite with Brent's variant of Pollard's rho
+ * @param n Odd composite number without factors below 1000
+ * @return A factor d with 1 < d < n
+ */
+uint64_t pollard_rho(uint64_t n) {
+    // Deterministic increments, so factorize() always returns the same result
+    for (uint64_t c = 1;; c++) {
+        auto step = [n, c](uint64_t x) {
+            return static_cast<uint64_t>((static_cast<unsigned __int128>(x) * x + c) % n);
+        };
+        uint64_t y = 2, x = 2, saved = 2, q = 1, d = 1;
+        constexpr uint64_t batch = 128;
+        for (uint64_t r = 1; d == 1; r <<= 1) {
+            x = y;
+            for (uint64_t i = 0; i < r; i++) y = step(y);
+            for (uint64_t k = 0; k < r && d == 1; k += batch) {
+                saved = y;
+                for (uint64_t i = 0; i < batch && i < r - k; i++) {
+                    y = step(y);
+                    q = detail::mul_mod(q, x > y ? x - y : y - x, n);
+                }
+                d = std::gcd(q, n);
+            }
+        }
+        if (d == n) {
+            // The batch overshot; redo it one step at a time
+            do {
+                saved = step(saved);
+                d = std::gcd(x > saved ? x - saved : saved - x, n);
+            } while (d == 1);
+        }
+        if (d != n) return d;
+    }
+}
+
+/**
+ * @brief Registry behind GoldenHash::shared()
+ */
+struct SharedInstances {
+    std::mutex mutex;
+    std::map<std::tuple<uint64_t, uint64_t, Reduction, uint32_t, uint32_t>, std::weak_ptr<const GoldenHash>> entries;
+};
+
+SharedInstances& shared_instances() {
+    static SharedInstances instances;
+    return instances;
+}
+
+/**
+ * @brief Check whether the running CPU can execute a SIMD level
+ */
+bool simd_level_supported(SimdLevel level) {
+    SimdLevel best = detect_simd_level();
+    switch (level) {
+        case SimdLevel::Scalar: return true;
+        case SimdLevel::AVX2: return best == SimdLevel::AVX2 || best == SimdLevel::AVX512;
+        case SimdLevel::AVX512: return best == SimdLevel::AVX512;
+        case SimdLevel::NEON: return best == SimdLevel::NEON;
+    }
+    return false;
+}
+
+/**
+ * @brief Level chosen by set_simd_level(), or the detected one
+ */
+std::atomic<SimdLevel>& active_simd_level() {
+    static std::atomic<SimdLevel> level{default_simd_level()};
+    return level;
+}
+
+} // namespace
+
 /**
  * @brief Constructor for GoldenHash
  * @param table_size Size of the hash table
  * @param seed Seed value for the hash function
+ * @param reduction Mapping of the final value into [0, N)
  */
-GoldenHash::GoldenHash(uint64_t table_size, uint64_t seed) : N(table_size), seed_(seed) {
-    // Find golden ratio primes
-    uint64_t target_high = N / GOLDEN_RATIO;
-    uint64_t target_low = N / (GOLDEN_RATIO * GOLDEN_RATIO);
-    
-    // Find nearest primes
-    prime_high = find_nearest_prime(target_high);
-    prime_low = find_nearest_prime(target_low);
+GoldenHash::GoldenHash(uint64_t table_size, uint64_t seed, Reduction reduction, SboxGeometry geometry)
+    : N(table_size), seed_(seed), reduction_(reduction), geometry_(geometry) {
+    if (!geometry_.valid()) {
+        throw std::invalid_argument("Unsupported S-box geometry: " + std::to_string(geometry_.num_sboxes) +
+                                    " S-boxes of " + std::to_string(geometry_.index_bits) + " index bits");
+    }
+    fastmod_magic_ = N ? ~static_cast<unsigned __int128>(0) / N + 1 : 0;
+    // Find golden ratio primes and the mixing constants
+    detail::HashParameters params = detail::derive_parameters(N, seed_);
+    prime_high = params.prime_high;
+    prime_low = params.prime_low;
+    prime_product = params.prime_product;
+    prime_mod = params.prime_mod;
+    working_mod = params.working_mod;
+    prime_mixed = params.prime_mixed;
+    initial_hash = params.initial_hash;
     
     // Factorize for mixed-radix if needed
     factors = factorize(N);
     
-    // Initialize compressive S-boxes (12-bit to 8-bit)
+    // Initialize compressive S-boxes (12-bit to 8-bit by default)
     // 4KB per S-box fits in L1 cache
-    for (size_t i = 0; i < NUM_SBOXES; i++) {
-        sboxes[i] = new (std::align_val_t(64)) uint8_t[SBOX_SIZE];
+    detail::generate_sboxes(params, sboxes, geometry_);
+    std::memset(sboxes + geometry_.bytes(), 0, SBOX_PADDING);
+}
+
+/**
+ * @brief Get a process-wide shared instance for a configuration
+ * @param table_size Size of the hash table
+ * @param seed Seed value for the hash function
+ * @param reduction Mapping of the final value into [0, N)
+ * @param geometry Number and size of the S-boxes
+ * @return Shared instance
+ */
+std::shared_ptr<const GoldenHash> GoldenHash::shared(uint64_t table_size, uint64_t seed, Reduction reduction,
+                                                     SboxGeometry geometry) {
+    SharedInstances& instances = shared_instances();
+    auto key = std::make_tuple(table_size, seed, reduction, geometry.num_sboxes, geometry.index_bits);
+    {
+        std::lock_guard<std::mutex> lock(instances.mutex);
+        auto it = instances.entries.find(key);
+        if (it != instances.entries.end()) {
+            if (auto existing = it->second.lock()) return existing;
+        }
     }
-    
-    // Generate S-box 1: compress 8 bits to 8 bits using golden ratio primes
-    // Use mixed AND/OR operations with primes for better mixing
-    prime_product = (prime_high * prime_low);
-    prime_mod = prime_product % N;
-    working_mod = (((N | prime_low) ^ (N & prime_high)) % (N << 4)) >> 4;
-    prime_mixed = (prime_product * (1 / GOLDEN_RATIO));
+    // Build outside the lock so a slow prime search does not stall lookups of
+    // other configurations
+    auto created = std::make_shared<const GoldenHash>(table_size, seed, reduction, geometry);
+    std::lock_guard<std::mutex> lock(instances.mutex);
+    std::weak_ptr<const GoldenHash>& slot = instances.entries[key];
+    if (auto existing = slot.lock()) return existing;  // Another thread won the race
+    slot = created;
+    // Forget configurations nobody references any more
+    std::erase_if(instances.entries, [](const auto& entry) { return entry.second.expired(); });
+    return created;
+}
 
-    uint64_t h = ((N ^ prime_product) * seed_) | (seed_ & 0xFFF);
-    h = (h * prime_product) ^ prime_mod;
-    h = (h * prime_low) ^ (prime_high);
-    h = (h & ~prime_mixed) | (((h ^ prime_product) >> 13) ^ working_mod);
-    h = ((h & prime_mixed) << 4) | (((h ^ prime_product) / working_mod) >> 4);
-    initial_hash = h;
-    for (size_t j = 0; j < NUM_SBOXES; j++) {
-        // Fill up sbox j
-        for (size_t i = 0; i < SBOX_SIZE; i++) {
-            // Mix using AND/OR operations with primes
-            h = (h * prime_product) ^ prime_mod;
-            sboxes[j][i] = ~((i ^ ((h & prime_low) ^ (h | prime_high))) ^ (h / prime_mod)) & 0xFF;
+/**
+ * @brief Hash a batch of independent keys
+ * @param keys Array of n pointers to key data
+ * @param lens Array of n key lengths in bytes
+ * @param out Array of n hash values in range [0, N)
+ * @param n Number of keys
+ */
+void GoldenHash::hash_batch(const uint8_t* const* keys, const size_t* lens, uint64_t* out, size_t n) const {
+    // Short keys are bucketed by exact length so that every lane of a group
+    // runs the same loop trip counts; mixed-length keys otherwise cost a couple
+    // of branch mispredictions per hash.
+    size_t pending[BATCH_MAX_LENGTH + 1][BATCH_LANES];
+    uint8_t fill[BATCH_MAX_LENGTH + 1] = {};
+    for (size_t i = 0; i < n; i++) {
+        size_t len = lens[i];
+        if (len > BATCH_MAX_LENGTH) {
+            out[i] = hash(keys[i], len);
+            continue;
+        }
+        // The key is only read once its group fills up, so start fetching it now
+        __builtin_prefetch(keys[i], 0, 3);
+        pending[len][fill[len]++] = i;
+        if (fill[len] == BATCH_LANES) {
+            hash_lanes(keys, len, pending[len], out);
+            fill[len] = 0;
+        }
+    }
+    // Leftover keys go through the single-key path
+    for (size_t len = 0; len <= BATCH_MAX_LENGTH; len++) {
+        for (size_t j = 0; j < fill[len]; j++) {
+            size_t i = pending[len][j];
+            out[i] = hash(keys[i], len);
         }
     }
 }
 
 /**
- * @brief Destructor - cleans up heap-allocated S-boxes
+ * @brief Get the kernel hash_batch() currently dispatches to
+ * @return Active SIMD level; defaults to the best x86 kernel the CPU supports
+ *         and to Scalar elsewhere
  */
-GoldenHash::~GoldenHash() {
-    for (size_t i = 0; i < NUM_SBOXES; i++) {
-        delete[] sboxes[i];
+SimdLevel GoldenHash::simd_level() {
+    return active_simd_level().load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Select the kernel used by hash_batch()
+ * @param level Requested level, lowered to the best one the CPU supports
+ * @return The level now in effect
+ */
+SimdLevel GoldenHash::set_simd_level(SimdLevel level) {
+    if (level == SimdLevel::AVX512 && !simd_level_supported(level)) {
+        level = SimdLevel::AVX2;
+    }
+    if (!simd_level_supported(level)) {
+        level = SimdLevel::Scalar;
     }
+    active_simd_level().store(level, std::memory_order_relaxed);
+    return level;
 }
 
+/**
+ * @brief Get the printable name of a SIMD level
+ * @param level SIMD level
+ * @return Name such as "avx2"
+ */
+const char* GoldenHash::simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+        case SimdLevel::NEON: return "neon";
+        default: return "scalar";
+    }
+}
+
+/**
+ * @brief Hash BATCH_LANES keys of the same length in lock-step
+ * @param keys Key pointers of the whole batch
+ * @param len Length shared by the selected keys
+ * @param indices Batch indices of the BATCH_LANES selected keys
+ * @param out Hash values of the whole batch
+ */
+void GoldenHash::hash_lanes(const uint8_t* const* keys, size_t len, const size_t* indices, uint64_t* out) const {
+    const uint8_t* data[BATCH_LANES];
+    for (size_t l = 0; l < BATCH_LANES; l++) {
+        data[l] = keys[indices[l]];
+    }
+    uint64_t h[BATCH_LANES];
+    switch (simd_level()) {
+#ifdef HAS_AVX2
+        case SimdLevel::AVX512:
+            mix_lanes_avx512(mix_constants(), data, len, h);
+            break;
+        case SimdLevel::AVX2:
+            mix_lanes_avx2(mix_constants(), data, len, h);
+            break;
+#elif defined(HAS_NEON)
+        case SimdLevel::NEON:
+            mix_lanes_neon(mix_constants(), data, len, h);
+            break;
+#endif
+        default:
+            mix_lanes(data, len, h);
+            break;
+    }
+    for (size_t l = 0; l < BATCH_LANES; l++) {
+        out[indices[l]] = reduce(h[l]);
+    }
+}
+
+/**
+ * @brief Portable lane kernel behind hash_lanes()
+ * @param data The BATCH_LANES keys
+ * @param len Length shared by the keys
+ * @param out Full 64-bit hash value of each lane
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+// The lanes are already independent scalar chains; GCC's vectorizer turns the
+// lane loops into gathers plus register spills and loses about 10-20%.
+__attribute__((optimize("no-tree-vectorize")))
+#endif
+void GoldenHash::mix_lanes(const uint8_t* const* data, size_t len, uint64_t* out) const {
+    uint64_t h[BATCH_LANES];
+    uint64_t state[BATCH_LANES];
+    uint64_t sbox_index[BATCH_LANES];
+    for (size_t l = 0; l < BATCH_LANES; l++) {
+        h[l] = initial_hash;
+        state[l] = seed_ ^ prime_product;
+        sbox_index[l] = ~state[l];
+    }
+    size_t words = len / 8;
+    size_t resync = stride_resync_word(len);
+    size_t shared_words = std::min(words, resync);
+    // Every lane starts from the same selector and each word advances it by a
+    // full turn, so up to the restart all lanes use the same S-box order.
+    const uint8_t* tables[NUM_SBOXES];
+    detail::select_tables(mix_constants(), sbox_index[0], tables);
+    // Mix the lanes side by side so their S-box loads overlap
+    for (size_t w = 0; w < shared_words; w++) {
+        for (size_t l = 0; l < BATCH_LANES; l++) {
+            mix_word(state[l], h[l], tables, detail::load_word(data[l] + w * 8));
+        }
+    }
+    if (resync <= words) {
+        for (size_t l = 0; l < BATCH_LANES; l++) {
+            sbox_index[l] = ~state[l];
+        }
+    }
+    for (size_t w = shared_words; w < words; w++) {
+        for (size_t l = 0; l < BATCH_LANES; l++) {
+            mix_word(state[l], h[l], sbox_index[l], detail::load_word(data[l] + w * 8));
+        }
+    }
+    for (size_t i = words * 8; i < len; i++) {
+        for (size_t l = 0; l < BATCH_LANES; l++) {
+            mix_byte(state[l], h[l], sbox_index[l], data[l][i]);
+        }
+    }
+    for (size_t l = 0; l < BATCH_LANES; l++) {
+        out[l] = avalanche(h[l], final_length(len));
+    }
+}
 
 /**
  * @brief Print information about the hash function configuration
@@ -93,6 +857,81 @@ void GoldenHash::print_info() const {
     for (auto f : factors) std::cout << f << " ";
     std::cout << "\n";
     std::cout << "Golden ratio check: N/prime_high = " << double(N)/prime_high << " (φ = " << GOLDEN_RATIO << ")\n";
+    std::cout << "Reduction: " << reduction_name(reduction_) << "\n";
+    std::cout << "S-boxes: " << sbox_geometry_name(geometry_) << " (" << geometry_.bytes() << " bytes)\n";
+}
+
+/**
+ * @brief Get the printable name of a reduction mode
+ * @param reduction Reduction mode
+ * @return Name as accepted by parse_reduction()
+ */
+const char* GoldenHash::reduction_name(Reduction reduction) {
+    switch (reduction) {
+        case Reduction::FastMod: return "fastmod";
+        case Reduction::FastRange: return "fastrange";
+        default: return "modulo";
+    }
+}
+
+/**
+ * @brief Parse a reduction mode name
+ * @param name "modulo", "fastmod" or "fastrange"
+ * @return Reduction mode
+ * @throws std::invalid_argument if the name is unknown
+ */
+Reduction GoldenHash::parse_reduction(const std::string& name) {
+    if (name == "modulo") return Reduction::Modulo;
+    if (name == "fastmod") return Reduction::FastMod;
+    if (name == "fastrange") return Reduction::FastRange;
+    throw std::invalid_argument("Unknown reduction: " + name);
+}
+
+/**
+ * @brief Get the printable name of an S-box geometry
+ * @param geometry S-box geometry
+ * @return Name such as "8x4k", as accepted by parse_sbox_geometry()
+ */
+std::string GoldenHash::sbox_geometry_name(SboxGeometry geometry) {
+    size_t size = geometry.sbox_size();
+    std::string suffix = size >= 1024 ? std::to_string(size / 1024) + "k" : std::to_string(size);
+    return std::to_string(geometry.num_sboxes) + "x" + suffix;
+}
+
+/**
+ * @brief Parse an S-box geometry name
+ * @param name "<count>x<size>" with the size in bytes, e.g. "2x4k", "8x1024" or "4x256"
+ * @return S-box geometry
+ * @throws std::invalid_argument if the name is malformed or the geometry is not valid()
+ */
+SboxGeometry GoldenHash::parse_sbox_geometry(const std::string& name) {
+    size_t x = name.find('x');
+    if (x == std::string::npos || x == 0 || x + 1 == name.size()) {
+        throw std::invalid_argument("Unknown S-box geometry: " + name);
+    }
+    std::string count = name.substr(0, x);
+    std::string size = name.substr(x + 1);
+    uint64_t multiplier = 1;
+    if (size.back() == 'k' || size.back() == 'K') {
+        multiplier = 1024;
+        size.pop_back();
+    }
+    auto all_digits = [](const std::string& text) {
+        return !text.empty() && text.size() <= 6 &&
+               std::all_of(text.begin(), text.end(), [](char ch) { return ch >= '0' && ch <= '9'; });
+    };
+    if (!all_digits(count) || !all_digits(size)) {
+        throw std::invalid_argument("Unknown S-box geometry: " + name);
+    }
+    uint64_t bytes = std::stoull(size) * multiplier;
+    SboxGeometry geometry;
+    geometry.num_sboxes = static_cast<uint32_t>(std::stoul(count));
+    geometry.index_bits = (bytes && (bytes & (bytes - 1)) == 0) ? __builtin_ctzll(bytes) : 0;
+    if (!geometry.valid()) {
+        throw std::invalid_argument("Unsupported S-box geometry: " + name +
+                                    " (1, 2, 4 or 8 S-boxes of 256 bytes to 4k)");
+    }
+    return geometry;
 }
 
 /**
@@ -119,6 +958,70 @@ uint64_t GoldenHash::get_prime_low() const { return prime_low; }
  */
 const std::vector<uint64_t>& GoldenHash::get_factors() const { return factors; }
 
+/**
+ * @brief Find the hash table with the best metrics for a given target
+ * @details Every candidate is measured on a pool worker. The results are
+ * merged in ascending size order afterwards, so the reported progress and the
+ * winner match a sequential search.
+ */
+void GoldenHash::find_best_table_size(int64_t target_size,
+                                      int64_t sizes_to_check,
+                                      int64_t multiple_of,
+                                      int64_t interations_to_search,
+                                      size_t num_threads) {
+    // Find a range between target_size where the modulus of the target size is == multiple_of, between -500 and +500 of target_size
+    int64_t halfway = sizes_to_check / 2 * multiple_of;
+    int64_t low_size = target_size - halfway;
+    int64_t high_size = target_size + halfway;
+    while (low_size % multiple_of != 0) {
+        low_size++;
+    }
+    while (high_size % multiple_of != 0) {
+        high_size++;
+    }
+    std::vector<int64_t> candidates;
+    for (int64_t i = low_size; i <= high_size; i += multiple_of) {
+        if ((i < 500) || i > std::numeric_limits<int64_t>::max() - 500) {
+            std::cout << "Size is too small or too large for GoldenHash: " << i << "\n";
+            return;
+        }
+        candidates.push_back(i);
+    }
+
+    // The keys do not depend on the table size, so every candidate shares one corpus
+    const std::vector<std::vector<uint8_t>> corpus = generate_test_corpus(interations_to_search);
+    std::vector<CollectiveMetrics> results(candidates.size());
+    ThreadPool pool(num_threads);
+    pool.parallel_for(candidates.size(), [&](size_t index, size_t) {
+        results[index] = run_tests_for(candidates[index], corpus);
+    });
+
+    CollectiveMetrics best_metrics;
+    bool value_collectd = false;
+    for (size_t i = 0; i < results.size(); i++) {
+        if (!value_collectd || results[i].is_better_than(best_metrics)) {
+            best_metrics = results[i];
+            value_collectd = true;
+            std::cout << "New best metrics found for size " << candidates[i] << ":\n";
+            std::cout << best_metrics.to_summary();
+        }
+    }
+    if (!value_collectd) {
+        std::cout << "No suitable table size found in the range.\n";
+    } else {
+        std::cout << "Best metrics found:\n";
+        std::cout << best_metrics.to_json() << "\n"
+                  << "Now running a full barage of tests on this final size.\n";
+        double speed = speed_test(best_metrics.table_size, 1000000);
+        std::cout << "Speed test for best size " << best_metrics.table_size << ": "
+                  << std::fixed << std::setprecision(8)
+                  << speed << " ns/hash\n";
+        CollectiveMetrics final_metrics = run_tests_for(best_metrics.table_size, 1000000);
+        std::cout << "Final metrics after full barrage:\n";
+        std::cout << final_metrics.to_json() << "\n";
+    }
+}
+
 /**
  * @brief Analyze S-box distribution and properties
  */
@@ -131,7 +1034,9 @@ void GoldenHash::analyze_sboxes() const {
     const std::string BLUE = "\033[34m";
     const std::string BOLD = "\033[1m";
     
-    std::cout << "\n" << BOLD << "=== S-BOX ANALYSIS (12-bit → 8-bit compression) ===" << RESET << "\n";
+    const size_t sbox_size = geometry_.sbox_size();
+    std::cout << "\n" << BOLD << "=== S-BOX ANALYSIS (" << geometry_.index_bits << "-bit → 8-bit compression, "
+              << sbox_geometry_name(geometry_) << ") ===" << RESET << "\n";
     
     // Create header for table
     std::cout << std::left << std::setw(10) << "S-box"
@@ -144,15 +1049,16 @@ void GoldenHash::analyze_sboxes() const {
               << "\n";
     std::cout << std::string(95, '-') << "\n";
     
-    for (size_t j = 0; j < NUM_SBOXES; j++) {
+    for (size_t j = 0; j < geometry_.num_sboxes; j++) {
+        const uint8_t* sbox = sboxes + j * sbox_size;
         // Count frequency of each output value
         std::vector<int> output_freq(256, 0);
-        for (size_t i = 0; i < SBOX_SIZE; i++) {
-            output_freq[sboxes[j][i]]++;
+        for (size_t i = 0; i < sbox_size; i++) {
+            output_freq[sbox[i]]++;
         }
         
         // Find min/max frequencies
-        int min_freq = SBOX_SIZE, max_freq = 0;
+        int min_freq = sbox_size, max_freq = 0;
         int unused_outputs = 0;
         for (int i = 0; i < 256; i++) {
             if (output_freq[i] == 0) unused_outputs++;
@@ -161,7 +1067,7 @@ void GoldenHash::analyze_sboxes() const {
         }
         
         // Calculate average frequency and standard deviation
-        double avg_freq = double(SBOX_SIZE) / 256.0;
+        double avg_freq = double(sbox_size) / 256.0;
         double variance = 0;
         for (int i = 0; i < 256; i++) {
             double diff = output_freq[i] - avg_freq;
@@ -171,8 +1077,8 @@ void GoldenHash::analyze_sboxes() const {
         
         // Bit distribution analysis
         std::vector<int> bit_count(8, 0);
-        for (size_t i = 0; i < SBOX_SIZE; i++) {
-            uint8_t val = sboxes[j][i];
+        for (size_t i = 0; i < sbox_size; i++) {
+            uint8_t val = sbox[i];
             for (int bit = 0; bit < 8; bit++) {
                 if (val & (1 << bit)) bit_count[bit]++;
             }
@@ -181,16 +1087,16 @@ void GoldenHash::analyze_sboxes() const {
         
         // Check for obvious patterns
         int sequential_count = 0;
-        for (size_t i = 1; i < SBOX_SIZE; i++) {
-            if (sboxes[j][i] == (sboxes[j][i-1] + 1) % 256) sequential_count++;
+        for (size_t i = 1; i < sbox_size; i++) {
+            if (sbox[i] == (sbox[i-1] + 1) % 256) sequential_count++;
         }
         
         // 1. Avalanche test: How many output bits change when input changes by 1
         double total_bit_changes = 0;
         int avalanche_tests = 0;
-        for (size_t i = 0; i < SBOX_SIZE - 1; i++) {
-            uint8_t val1 = sboxes[j][i];
-            uint8_t val2 = sboxes[j][i + 1];
+        for (size_t i = 0; i < sbox_size - 1; i++) {
+            uint8_t val1 = sbox[i];
+            uint8_t val2 = sbox[i + 1];
             uint8_t diff = val1 ^ val2;
             int bits_changed = __builtin_popcount(diff);
             total_bit_changes += bits_changed;
@@ -205,9 +1111,10 @@ void GoldenHash::analyze_sboxes() const {
         std::vector<int> test_diffs = {1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048};
         
         for (int in_diff : test_diffs) {
+            if (size_t(in_diff) >= sbox_size) break;
             std::map<int, int> out_diff_count;
-            for (size_t i = 0; i < SBOX_SIZE - in_diff; i++) {
-                int out_diff = (sboxes[j][i + in_diff] - sboxes[j][i] + 256) & 0xFF;
+            for (size_t i = 0; i < sbox_size - in_diff; i++) {
+                int out_diff = (sbox[i + in_diff] - sbox[i] + 256) & 0xFF;
                 out_diff_count[out_diff]++;
             }
             for (const auto& pair : out_diff_count) {
@@ -216,13 +1123,13 @@ void GoldenHash::analyze_sboxes() const {
         }
         
         // 3. Non-linearity measure: distance from nearest affine function
-        int min_matches = SBOX_SIZE;
+        int min_matches = sbox_size;
         for (int a = 0; a < 8; a++) {  // Test a few linear functions
             for (int b = 0; b < 8; b++) {
                 int matches = 0;
-                for (size_t i = 0; i < SBOX_SIZE; i++) {
+                for (size_t i = 0; i < sbox_size; i++) {
                     uint8_t expected = (a * i + b) & 0xFF;
-                    if (sboxes[j][i] == expected) matches++;
+                    if (sbox[i] == expected) matches++;
                 }
                 if (matches < min_matches) min_matches = matches;
             }
@@ -250,20 +1157,20 @@ void GoldenHash::analyze_sboxes() const {
             std::cout << RED << std::setw(15) << avg_avalanche << RESET;
         }
         
-        // Differential uniformity (color based on quality)
-        if (max_diff_count <= 64) {
+        // Differential uniformity (color based on quality, relative to the S-box size)
+        if (max_diff_count <= int(sbox_size / 64)) {
             std::cout << GREEN << std::setw(18) << max_diff_count << RESET;
-        } else if (max_diff_count <= 128) {
+        } else if (max_diff_count <= int(sbox_size / 32)) {
             std::cout << YELLOW << std::setw(18) << max_diff_count << RESET;
         } else {
             std::cout << RED << std::setw(18) << max_diff_count << RESET;
         }
         
         // Linearity
-        std::cout << std::setw(15) << (std::to_string(min_matches) + "/" + std::to_string(SBOX_SIZE));
+        std::cout << std::setw(15) << (std::to_string(min_matches) + "/" + std::to_string(sbox_size));
         
         // Sequential patterns
-        if (sequential_count < 100) {
+        if (sequential_count < int(100 * sbox_size / SBOX_SIZE)) {
             std::cout << GREEN << std::setw(15) << sequential_count << RESET;
         } else {
             std::cout << RED << std::setw(15) << sequential_count << RESET;
@@ -276,7 +1183,7 @@ void GoldenHash::analyze_sboxes() const {
     std::cout << "\n" << BOLD << "Legend:" << RESET << "\n";
     std::cout << "  Unused: " << GREEN << "0 is good" << RESET << ", " << RED << ">0 is bad" << RESET << "\n";
     std::cout << "  Bit Changes: " << GREEN << "~4.0 is ideal" << RESET << " (50% avalanche)\n";
-    std::cout << "  Diff Uniformity: " << GREEN << "≤64 good" << RESET << ", " << YELLOW << "≤128 okay" << RESET << ", " << RED << ">128 poor" << RESET << " (for 12→8 bit S-box)\n";
+    std::cout << "  Diff Uniformity: " << GREEN << "≤" << sbox_size / 64 << " good" << RESET << ", " << YELLOW << "≤" << sbox_size / 32 << " okay" << RESET << ", " << RED << ">" << sbox_size / 32 << " poor" << RESET << " (for " << geometry_.index_bits << "→8 bit S-box)\n";
     std::cout << "  Lower is better for: Linearity, Sequential\n";
 }
 
@@ -286,13 +1193,7 @@ void GoldenHash::analyze_sboxes() const {
  * @return True if n is prime, false otherwise
  */
 bool GoldenHash::is_prime(uint64_t n) const {
-    if (n < 2) return false;
-    if (n == 2) return true;
-    if (n % 2 == 0) return false;
-    for (uint64_t i = 3; i * i <= n; i += 2) {
-        if (n % i == 0) return false;
-    }
-    return true;
+    return detail::is_prime(n);
 }
 
 /**
@@ -302,16 +1203,29 @@ bool GoldenHash::is_prime(uint64_t n) const {
  */
 std::vector<uint64_t> GoldenHash::factorize(uint64_t n) {
     std::vector<uint64_t> factors;
+    if (n < 2) return factors;
+    // Small factors by trial division, the cofactor by Pollard's rho
     uint64_t temp = n;
-    
-    for (uint64_t i = 2; i * i <= temp; i++) {
+    for (uint64_t i = 2; i < 1000 && i * i <= temp; i++) {
         while (temp % i == 0) {
             factors.push_back(i);
             temp /= i;
         }
     }
-    if (temp > 1) factors.push_back(temp);
-    
+    std::vector<uint64_t> pending;
+    if (temp > 1) pending.push_back(temp);
+    while (!pending.empty()) {
+        uint64_t m = pending.back();
+        pending.pop_back();
+        if (detail::is_prime(m)) {
+            factors.push_back(m);
+            continue;
+        }
+        uint64_t d = pollard_rho(m);
+        pending.push_back(d);
+        pending.push_back(m / d);
+    }
+    std::sort(factors.begin(), factors.end());
     return factors;
 }
 
@@ -321,12 +1235,7 @@ std::vector<uint64_t> GoldenHash::factorize(uint64_t n) {
  * @return Nearest prime number
  */
 uint64_t GoldenHash::find_nearest_prime(uint64_t target) const {
-    // Search outward from target
-    for (uint64_t delta = 0; delta < 1000; delta++) {
-        if (target > delta && is_prime(target - delta)) return target - delta;
-        if (is_prime(target + delta)) return target + delta;
-    }
-    return target; // Fallback
+    return detail::find_nearest_prime(target);
 }
 
 } // namespace goldenhash
\ No newline at end of file
@@ -0,0 +1,502 @@
+/**
+ * Copyright 2025 Josh Morgan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file goldenhash_bench.cpp
+ * @brief Key-size sweep microbenchmark for GoldenHash and the baseline algorithms
+ * @author Josh Morgan
+ * @date 2025
+ *
+ * Hashes a small pool of keys of one fixed length (or of one length
+ * distribution) over and over, so every code path of a hash is measured on
+ * its own instead of blended into a single number. Each case runs in three
+ * modes:
+ *   - latency: the next key is picked by the previous hash, so calls cannot overlap
+ *   - throughput: independent calls the CPU is free to overlap
+ *   - batch: the whole pool through hash_batch()
+ * Cycles are read from the time-stamp counter, which counts at a constant
+ * reference rate rather than the current core clock.
+ */
+
+#include <goldenhash.hpp>
+#include <goldenhash/tests/hash_algorithms.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <getopt.h>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#define GOLDENHASH_BENCH_HAVE_TSC 1
+#endif
+
+using namespace goldenhash;
+using namespace goldenhash::tests;
+
+namespace {
+
+constexpr size_t POOL_BYTES = 256 * 1024;  // Keeps the key pool in L2
+constexpr size_t MAX_POOL_KEYS = 1024;
+constexpr size_t MIN_POOL_KEYS = 16;
+
+const std::vector<size_t> DEFAULT_LENGTHS = {
+    0, 1, 2, 3, 4, 5, 7, 8, 9, 12, 15, 16, 17, 24, 31, 32, 33, 48, 63, 64, 65,
+    96, 127, 128, 129, 256, 512, 1024, 2048, 4096
+};
+
+/**
+ * @brief Key lengths drawn uniformly from [min, max]
+ */
+struct Distribution {
+    std::string name;
+    size_t min;
+    size_t max;
+};
+
+const std::vector<Distribution> DEFAULT_DISTRIBUTIONS = {
+    {"uniform-1-16", 1, 16},
+    {"uniform-16-64", 16, 64},   // The mix of GoldenHash::speed_test()
+    {"uniform-1-256", 1, 256},
+};
+
+/**
+ * @brief Keys laid out back to back, each with its own length
+ */
+struct KeyPool {
+    std::vector<uint8_t> bytes;
+    std::vector<const uint8_t*> keys;
+    std::vector<size_t> lengths;
+    size_t total_bytes = 0;
+
+    size_t size() const { return keys.size(); }
+};
+
+/**
+ * @brief A pool of random keys with lengths in [min_len, max_len]
+ * @details The key count is a power of two so that a hash can be masked into a key index.
+ */
+KeyPool make_pool(size_t min_len, size_t max_len, uint64_t seed) {
+    size_t count = MAX_POOL_KEYS;
+    while (count > MIN_POOL_KEYS && count * max_len > POOL_BYTES) {
+        count /= 2;
+    }
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<size_t> length_of(min_len, max_len);
+    KeyPool pool;
+    pool.lengths.resize(count);
+    for (size_t& length : pool.lengths) {
+        length = length_of(rng);
+        pool.total_bytes += length;
+    }
+    // One spare byte so that the key pointers of an all-empty pool stay valid
+    pool.bytes.resize(pool.total_bytes + 1);
+    for (uint8_t& byte : pool.bytes) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    pool.keys.resize(count);
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        pool.keys[i] = pool.bytes.data() + offset;
+        offset += pool.lengths[i];
+    }
+    return pool;
+}
+
+uint64_t read_tsc() {
+#ifdef GOLDENHASH_BENCH_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * @brief Time-stamp counter ticks per nanosecond, measured against the steady clock
+ */
+double calibrate_tsc() {
+#ifdef GOLDENHASH_BENCH_HAVE_TSC
+    uint64_t start_ns = now_ns();
+    uint64_t start_tsc = read_tsc();
+    while (now_ns() - start_ns < 50'000'000) {
+    }
+    return static_cast<double>(read_tsc() - start_tsc) / static_cast<double>(now_ns() - start_ns);
+#else
+    return 0.0;
+#endif
+}
+
+enum class Mode { Latency, Throughput, Batch };
+
+const char* mode_name(Mode mode) {
+    switch (mode) {
+        case Mode::Latency: return "latency";
+        case Mode::Throughput: return "throughput";
+        case Mode::Batch: return "batch";
+    }
+    return "?";
+}
+
+/**
+ * @brief One measured case
+ */
+struct BenchResult {
+    std::string algorithm;
+    std::string keys;       // Fixed length as a number, or a distribution name
+    Mode mode;
+    double mean_length;
+    double ns_per_hash;
+    double ticks_per_hash;  // Time-stamp counter ticks, 0 without a TSC
+};
+
+// Folding every hash into a checksum keeps the compiler from dropping the calls
+volatile uint64_t benchmark_checksum = 0;
+
+/**
+ * @brief Hash passes over the pool in one mode
+ * @param out Scratch of pool.size() hashes for batch mode
+ * @return Number of hashes computed
+ */
+template <typename Fn>
+size_t run_passes(Fn& fn, const KeyPool& pool, Mode mode, size_t passes, std::vector<uint64_t>& out) {
+    size_t n = pool.size();
+    size_t mask = n - 1;
+    uint64_t checksum = 0;
+    switch (mode) {
+        case Mode::Latency: {
+            // The key index depends on the previous hash, which serialises the calls
+            uint64_t h = 0;
+            for (size_t i = 0; i < passes * n; ++i) {
+                size_t index = (h ^ i) & mask;
+                h = fn(pool.keys[index], pool.lengths[index]);
+            }
+            checksum = h;
+            break;
+        }
+        case Mode::Throughput:
+            for (size_t pass = 0; pass < passes; ++pass) {
+                for (size_t i = 0; i < n; ++i) {
+                    checksum ^= fn(pool.keys[i], pool.lengths[i]);
+                }
+            }
+            break;
+        case Mode::Batch:
+            for (size_t pass = 0; pass < passes; ++pass) {
+                hash_batch(fn, pool.keys.data(), pool.lengths.data(), out.data(), n);
+                checksum ^= out[pass & mask];
+            }
+            break;
+    }
+    benchmark_checksum = benchmark_checksum ^ checksum;
+    return passes * n;
+}
+
+/**
+ * @brief Measure one case: best of trials, each at least min_ns long
+ */
+template <typename Fn>
+BenchResult measure(Fn& fn, const KeyPool& pool, Mode mode, size_t trials, uint64_t min_ns) {
+    std::vector<uint64_t> out(pool.size());
+    // Warm up, then grow the pass count until one trial takes min_ns
+    size_t passes = 1;
+    run_passes(fn, pool, mode, passes, out);
+    while (true) {
+        uint64_t start = now_ns();
+        run_passes(fn, pool, mode, passes, out);
+        uint64_t elapsed = now_ns() - start;
+        if (elapsed >= min_ns || passes >= (size_t{1} << 30)) break;
+        passes *= elapsed > 0 ? std::clamp<size_t>(min_ns / elapsed + 1, 2, 16) : 16;
+    }
+    BenchResult result{};
+    result.mode = mode;
+    result.mean_length = static_cast<double>(pool.total_bytes) / pool.size();
+    result.ns_per_hash = INFINITY;
+    for (size_t trial = 0; trial < trials; ++trial) {
+        uint64_t start = now_ns();
+        uint64_t start_tsc = read_tsc();
+        size_t hashes = run_passes(fn, pool, mode, passes, out);
+        uint64_t ticks = read_tsc() - start_tsc;
+        uint64_t elapsed = now_ns() - start;
+        double ns = static_cast<double>(elapsed) / hashes;
+        if (ns < result.ns_per_hash) {
+            result.ns_per_hash = ns;
+            result.ticks_per_hash = static_cast<double>(ticks) / hashes;
+        }
+    }
+    return result;
+}
+
+void print_usage(const char* program) {
+    std::string algorithm_names;
+    for (const HashAlgorithm& algorithm : hash_algorithms()) {
+        if (!algorithm_names.empty()) algorithm_names += ", ";
+        algorithm_names += algorithm.name;
+    }
+    std::cout << "Usage: " << program << " [options]\n"
+              << "\nOptions:\n"
+              << "  --algorithm <names> Comma-separated algorithms or 'all' (default: goldenhash)\n"
+              << "                     Known: " << algorithm_names << "\n"
+              << "  --lengths <list>   Comma-separated key lengths (default: 0 to 4096 in steps\n"
+              << "                     around every block boundary)\n"
+              << "  --no-distributions Skip the mixed-length cases\n"
+              << "  --mode <name>      latency, throughput, batch or all (default: all)\n"
+              << "  --table-size <n>   Table size the hashes are reduced to (default: 1000003)\n"
+              << "  --reduction <mode> GoldenHash range reduction: modulo, fastmod, fastrange (default: modulo)\n"
+              << "  --sboxes <geom>    GoldenHash S-box geometry, e.g. 8x4k, 2x4k, 8x1k (default: 8x4k)\n"
+              << "  --trials <n>       Trials per case, the fastest is reported (default: 5)\n"
+              << "  --min-time <ms>    Minimum duration of one trial (default: 20)\n"
+              << "  --json             Output results in JSON format\n"
+              << "  --help             Show this help message\n";
+}
+
+std::vector<std::string> split_list(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+void print_table(const std::vector<BenchResult>& results, bool have_tsc) {
+    std::cout << std::left << std::setw(10) << "Algorithm"
+              << " | " << std::setw(13) << "Keys"
+              << " | " << std::setw(10) << "Mode" << std::right
+              << " | " << std::setw(9) << "ns/hash"
+              << " | " << std::setw(10) << "cyc/hash"
+              << " | " << std::setw(9) << "cyc/byte"
+              << " | " << std::setw(9) << "GB/s" << "\n";
+    std::cout << std::string(10, '-') << "-+-" << std::string(13, '-') << "-+-" << std::string(10, '-')
+              << "-+-" << std::string(9, '-') << "-+-" << std::string(10, '-') << "-+-" << std::string(9, '-')
+              << "-+-" << std::string(9, '-') << "\n";
+    for (const auto& r : results) {
+        std::cout << std::left << std::setw(10) << r.algorithm
+                  << " | " << std::setw(13) << r.keys
+                  << " | " << std::setw(10) << mode_name(r.mode) << std::right
+                  << " | " << std::setw(9) << std::fixed << std::setprecision(2) << r.ns_per_hash;
+        if (have_tsc) {
+            std::cout << " | " << std::setw(10) << std::setprecision(1) << r.ticks_per_hash;
+            if (r.mean_length > 0) {
+                std::cout << " | " << std::setw(9) << std::setprecision(3) << r.ticks_per_hash / r.mean_length;
+            } else {
+                std::cout << " | " << std::setw(9) << "-";
+            }
+        } else {
+            std::cout << " | " << std::setw(10) << "-" << " | " << std::setw(9) << "-";
+        }
+        std::cout << " | " << std::setw(9) << std::setprecision(3) << r.mean_length / r.ns_per_hash << "\n";
+    }
+}
+
+void print_json(const std::vector<BenchResult>& results, uint64_t table_size, Reduction reduction,
+                SboxGeometry geometry, double tsc_per_ns) {
+    std::cout << "{\n";
+    std::cout << "  \"table_size\": " << table_size << ",\n";
+    std::cout << "  \"reduction\": \"" << GoldenHash::reduction_name(reduction) << "\",\n";
+    std::cout << "  \"sboxes\": \"" << GoldenHash::sbox_geometry_name(geometry) << "\",\n";
+    std::cout << "  \"tsc_ghz\": " << std::fixed << std::setprecision(3) << tsc_per_ns << ",\n";
+    std::cout << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        std::cout << "    {\"algorithm\": \"" << r.algorithm << "\", \"keys\": \"" << r.keys
+                  << "\", \"mode\": \"" << mode_name(r.mode) << "\""
+                  << ", \"mean_length\": " << std::setprecision(2) << r.mean_length
+                  << ", \"ns_per_hash\": " << std::setprecision(3) << r.ns_per_hash;
+        if (tsc_per_ns > 0) {
+            std::cout << ", \"cycles_per_hash\": " << std::setprecision(2) << r.ticks_per_hash
+                      << ", \"cycles_per_byte\": ";
+            if (r.mean_length > 0) {
+                std::cout << std::setprecision(4) << r.ticks_per_hash / r.mean_length;
+            } else {
+                std::cout << "null";
+            }
+        } else {
+            std::cout << ", \"cycles_per_hash\": null, \"cycles_per_byte\": null";
+        }
+        std::cout << ", \"gb_per_s\": " << std::setprecision(3) << r.mean_length / r.ns_per_hash << "}"
+                  << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    std::cout << "  ]\n";
+    std::cout << "}\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> algorithm_names = {"goldenhash"};
+    std::vector<size_t> lengths = DEFAULT_LENGTHS;
+    bool distributions = true;
+    std::vector<Mode> modes = {Mode::Latency, Mode::Throughput, Mode::Batch};
+    uint64_t table_size = 1000003;
+    Reduction reduction = Reduction::Modulo;
+    SboxGeometry geometry;
+    size_t trials = 5;
+    uint64_t min_time_ms = 20;
+    bool json_output = false;
+    std::optional<GoldenHash> hasher;
+
+    static struct option long_options[] = {
+        {"algorithm", required_argument, 0, 'a'},
+        {"lengths", required_argument, 0, 'l'},
+        {"no-distributions", no_argument, 0, 'D'},
+        {"mode", required_argument, 0, 'm'},
+        {"table-size", required_argument, 0, 'N'},
+        {"reduction", required_argument, 0, 'r'},
+        {"sboxes", required_argument, 0, 's'},
+        {"trials", required_argument, 0, 't'},
+        {"min-time", required_argument, 0, 'T'},
+        {"json", no_argument, 0, 'j'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    int option_index = 0;
+    try {
+        while ((opt = getopt_long(argc, argv, "a:l:Dm:N:r:s:t:T:jh", long_options, &option_index)) != -1) {
+            switch (opt) {
+                case 'a':
+                    algorithm_names.clear();
+                    if (std::string(optarg) == "all") {
+                        for (const HashAlgorithm& algorithm : hash_algorithms()) {
+                            if (algorithm.supported()) algorithm_names.emplace_back(algorithm.name);
+                        }
+                    } else {
+                        algorithm_names = split_list(optarg);
+                    }
+                    break;
+                case 'l':
+                    lengths.clear();
+                    for (const std::string& item : split_list(optarg)) {
+                        lengths.push_back(std::stoull(item));
+                    }
+                    break;
+                case 'D':
+                    distributions = false;
+                    break;
+                case 'm': {
+                    std::string mode = optarg;
+                    if (mode == "all") {
+                        modes = {Mode::Latency, Mode::Throughput, Mode::Batch};
+                    } else if (mode == "latency") {
+                        modes = {Mode::Latency};
+                    } else if (mode == "throughput") {
+                        modes = {Mode::Throughput};
+                    } else if (mode == "batch") {
+                        modes = {Mode::Batch};
+                    } else {
+                        throw std::invalid_argument("Unknown mode: " + mode);
+                    }
+                    break;
+                }
+                case 'N':
+                    table_size = std::stoull(optarg);
+                    break;
+                case 'r':
+                    reduction = GoldenHash::parse_reduction(optarg);
+                    break;
+                case 's':
+                    geometry = GoldenHash::parse_sbox_geometry(optarg);
+                    break;
+                case 't':
+                    trials = std::max<size_t>(1, std::stoull(optarg));
+                    break;
+                case 'T':
+                    min_time_ms = std::stoull(optarg);
+                    break;
+                case 'j':
+                    json_output = true;
+                    break;
+                case 'h':
+                    print_usage(argv[0]);
+                    return 0;
+                default:
+                    print_usage(argv[0]);
+                    return 1;
+            }
+        }
+        for (const std::string& name : algorithm_names) {
+            if (!find_hash_algorithm(name).supported()) {
+                throw std::runtime_error(name + " is not available in this build or on this CPU");
+            }
+        }
+        // Throws std::invalid_argument for unsupported table sizes
+        hasher.emplace(table_size, 0, reduction, geometry);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    double tsc_per_ns = calibrate_tsc();
+    uint64_t min_ns = min_time_ms * 1'000'000;
+
+    // Every algorithm sees the same pools
+    std::vector<std::pair<std::string, KeyPool>> pools;
+    for (size_t length : lengths) {
+        pools.emplace_back(std::to_string(length), make_pool(length, length, length));
+    }
+    if (distributions) {
+        for (const Distribution& d : DEFAULT_DISTRIBUTIONS) {
+            pools.emplace_back(d.name, make_pool(d.min, d.max, d.min * 1000 + d.max));
+        }
+    }
+
+    std::vector<BenchResult> results;
+    for (const std::string& name : algorithm_names) {
+        HashFunction hash_function = find_hash_algorithm(name).make(table_size, *hasher);
+        std::visit([&](auto& fn) {
+            for (const auto& [keys, pool] : pools) {
+                for (Mode mode : modes) {
+                    BenchResult result = measure(fn, pool, mode, trials, min_ns);
+                    result.algorithm = name;
+                    result.keys = keys;
+                    results.push_back(result);
+                }
+            }
+        }, hash_function);
+    }
+
+    if (json_output) {
+        print_json(results, table_size, reduction, geometry, tsc_per_ns);
+    } else {
+        std::cout << "Table size: " << table_size << ", reduction: " << GoldenHash::reduction_name(reduction)
+                  << ", S-boxes: " << GoldenHash::sbox_geometry_name(geometry);
+        if (tsc_per_ns > 0) {
+            std::cout << ", TSC: " << std::fixed << std::setprecision(2) << tsc_per_ns << " GHz";
+        }
+        std::cout << "\n\n";
+        print_table(results, tsc_per_ns > 0);
+        if (tsc_per_ns > 0) {
+            std::cout << "\nCycles are time-stamp counter ticks at the constant TSC rate.\n";
+        }
+    }
+    return 0;
+}
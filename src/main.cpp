@@ -25,8 +25,11 @@
  */
 
 #include <goldenhash.hpp>
+#include <goldenhash/thread_pool.hpp>
 #include <goldenhash/tests/common.hpp>
 #include <goldenhash/tests/test_runner.hpp>
+#include <goldenhash/tests/sweep.hpp>
+#include <goldenhash/tests/pipeline.hpp>
 
 #include <iostream>
 #include <iomanip>
@@ -38,10 +41,62 @@
 #include <getopt.h>
 #include <filesystem>
 #include <algorithm>
+#include <random>
 
 using namespace goldenhash;
 using namespace goldenhash::tests;
 
+/**
+ * @brief Print the hardware counters of the benchmark loops, per hash
+ */
+void print_perf_counters(const std::vector<ComparisonResult>& results) {
+    std::cout << "\nHardware counters per hash:\n";
+    std::cout << std::left << std::setw(10) << "Algorithm" << std::right
+              << " | " << std::setw(9) << "Cycles"
+              << " | " << std::setw(9) << "Instr."
+              << " | " << std::setw(5) << "IPC"
+              << " | " << std::setw(9) << "L1D miss"
+              << " | " << std::setw(9) << "Br. miss" << "\n";
+    std::cout << std::string(10, '-') << "-+-" << std::string(9, '-') << "-+-" << std::string(9, '-')
+              << "-+-" << std::string(5, '-') << "-+-" << std::string(9, '-') << "-+-" << std::string(9, '-') << "\n";
+    for (const auto& r : results) {
+        if (!r.perf_collected) continue;
+        auto column = [&](PerfSample::Counter counter, int precision) {
+            std::ostringstream out;
+            if (r.perf.present[counter]) {
+                out << std::fixed << std::setprecision(precision) << r.perf.per_hash(counter);
+            } else {
+                out << "N/A";
+            }
+            return out.str();
+        };
+        std::cout << std::left << std::setw(10) << r.algorithm << std::right
+                  << " | " << std::setw(9) << column(PerfSample::CYCLES, 1)
+                  << " | " << std::setw(9) << column(PerfSample::INSTRUCTIONS, 1)
+                  << " | " << std::setw(5) << std::fixed << std::setprecision(2) << r.perf.ipc()
+                  << " | " << std::setw(9) << column(PerfSample::L1D_MISSES, 3)
+                  << " | " << std::setw(9) << column(PerfSample::BRANCH_MISSES, 3) << "\n";
+    }
+}
+
+/**
+ * @brief Hardware counters as a JSON object, null for counters the CPU does not provide
+ */
+std::string perf_counters_json(const PerfSample& perf) {
+    std::ostringstream out;
+    out << "{\"hashes\": " << perf.hashes;
+    for (size_t i = 0; i < PerfSample::NUM_COUNTERS; ++i) {
+        out << ", \"" << PerfSample::NAMES[i] << "\": ";
+        if (perf.present[i]) {
+            out << perf.values[i];
+        } else {
+            out << "null";
+        }
+    }
+    out << ", \"ipc\": " << perf.ipc() << "}";
+    return out.str();
+}
+
 void display_comparison_table(const std::vector<ComparisonResult>& results) {
     if (results.empty()) return;
     
@@ -116,11 +171,25 @@ void display_comparison_table(const std::vector<ComparisonResult>& results) {
         std::cout << "  Collisions: Actual number of hash collisions detected\n";
     }
     
+    if (std::any_of(results.begin(), results.end(), [](const auto& r) { return r.perf_collected; })) {
+        print_perf_counters(results);
+    }
+    
+    if (std::any_of(results.begin(), results.end(), [](const auto& r) { return r.sac_collected; })) {
+        std::cout << "\nStrict Avalanche / Bit Independence:\n";
+        for (const auto& r : results) {
+            if (!r.sac_collected) continue;
+            std::cout << "  " << std::left << std::setw(10) << r.algorithm << std::right
+                      << " SAC bias: " << std::fixed << std::setprecision(6) << r.sac_bias
+                      << "  BIC max |r|: " << std::setprecision(6) << r.bic_max_correlation << "\n";
+        }
+    }
+    
     std::cout << "\n";
 }
 
 void output_json_results(const ComparisonResult& result, uint64_t table_size, 
-                               uint64_t num_iterations, GoldenHash& hasher) {
+                               uint64_t num_iterations, const GoldenHash& hasher) {
     // Generate test vectors
     std::vector<std::pair<std::string, uint64_t>> test_hashes;
     const std::vector<std::string> test_strings = {
@@ -154,21 +223,89 @@ void output_json_results(const ComparisonResult& result, uint64_t table_size,
     }
     std::cout << "\",\n";
     std::cout << "  \"performance_ns_per_hash\": " << result.ns_per_hash << ",\n";
-    std::cout << "  \"throughput_mbs\": " << result.throughput_mbs << "\n";
-    std::cout << "}\n";
+    std::cout << "  \"throughput_mbs\": " << result.throughput_mbs;
+    if (result.perf_collected) {
+        std::cout << ",\n  \"perf_counters\": " << perf_counters_json(result.perf);
+    }
+    std::cout << "\n}\n";
+}
+
+void print_pipeline_report(const PipelineResult& result, const std::string& algorithm, bool json_output) {
+    auto stage_json = [](const StageLatency& stage) {
+        std::ostringstream out;
+        out << "{\"p50_ns\": " << stage.p50_ns << ", \"p99_ns\": " << stage.p99_ns
+            << ", \"samples\": " << stage.samples << "}";
+        return out.str();
+    };
+    if (json_output) {
+        std::cout << "{\"algorithm\": \"" << algorithm << "\""
+                  << ", \"producers\": " << result.num_producers
+                  << ", \"consumers\": " << result.num_consumers
+                  << ", \"hashes\": " << result.total_hashes
+                  << ", \"elapsed_ms\": " << result.elapsed_ms
+                  << ", \"hashes_per_second\": " << result.hashes_per_second
+                  << ", \"throughput_mbs\": " << result.throughput_mbs
+                  << ", \"hash\": " << stage_json(result.hash_stage)
+                  << ", \"queue\": " << stage_json(result.queue_stage)
+                  << ", \"insert\": " << stage_json(result.insert_stage)
+                  << "}\n";
+        return;
+    }
+    std::cout << "\n=== PIPELINE: " << algorithm << " (" << result.num_producers << " producers, "
+              << result.num_consumers << " consumers) ===\n"
+              << std::fixed << std::setprecision(1)
+              << "  Hashes:     " << result.total_hashes << " in " << result.elapsed_ms << " ms\n"
+              << "  Throughput: " << result.hashes_per_second / 1e6 << " M hashes/s, "
+              << result.throughput_mbs << " MB/s, " << result.ns_per_hash << " ns/hash\n"
+              << "  Stage        p50 (ns)    p99 (ns)\n";
+    auto stage_line = [](const char* name, const StageLatency& stage) {
+        std::cout << "  " << std::left << std::setw(10) << name << std::right
+                  << std::setw(11) << stage.p50_ns << std::setw(12) << stage.p99_ns << "\n";
+    };
+    stage_line("hash", result.hash_stage);
+    stage_line("queue", result.queue_stage);
+    stage_line("insert", result.insert_stage);
+    std::cout << "\n";
 }
 
 void print_usage(const char* program) {
+    std::string algorithm_names;
+    for (const HashAlgorithm& algorithm : hash_algorithms()) {
+        if (!algorithm_names.empty()) algorithm_names += ", ";
+        algorithm_names += algorithm.name;
+    }
     std::cout << "Usage: " << program << " <table_size> <iterations> [options]\n"
+              << "       " << program << " --sweep <start:end[:step]> [iterations] [options]\n"
               << "\nOptions:\n"
               << "  --threads <n>      Number of threads (default: hardware concurrency)\n"
-              << "  --force-sqlite     Force SQLite storage for all tests\n"
+              << "  --affinity <cpus>  Pin the benchmark threads to these CPUs, e.g. 0-7; with at least\n"
+              << "                     twice --threads distinct CPUs the --metrics workers are pinned to\n"
+              << "                     the rest and run alongside the benchmarks, otherwise after them\n"
+              << "  --force-sqlite     Use on-disk storage: SQLite shards and a memory-mapped test corpus\n"
               << "  --compare          Compare all hash algorithms\n"
-              << "  --algorithm <name> Test specific algorithm (goldenhash, xxhash64, sha256, aes-cmac)\n"
+              << "  --algorithm <name> Test specific algorithm (" << algorithm_names << ")\n"
               << "  --json             Output results in JSON format\n"
               << "  --metrics          Enable detailed metrics collection (avalanche, chi-squared, collisions)\n"
-              << "  --collision-db <path> Store collisions in SQLite database\n"
+              << "  --avalanche-stride <n> Run the avalanche test on every n-th key (default: 100)\n"
+              << "  --sac              Also collect the strict avalanche (SAC) and bit independence (BIC)\n"
+              << "                     matrices over the first 512 input bits\n"
+              << "  --perf-counters    Read cycles, instructions, L1D misses and branch misses around\n"
+              << "                     each benchmark loop (Linux perf_event_open)\n"
+              << "  --collision-db <path> Store collisions in SQLite database; the run row counts all\n"
+              << "                     collisions, the collision rows are the pairs within one thread's keys\n"
               << "  --hash-bits <n>    Test with n-bit hashes (default: based on table size)\n"
+              << "  --reduction <mode> GoldenHash range reduction: modulo, fastmod, fastrange (default: modulo)\n"
+              << "  --sweep <start:end[:step]> Measure every table size of the range in this process,\n"
+              << "                     writing one JSON line per size\n"
+              << "  --target-collisions <k> In a sweep, hash only as many keys as expect k collisions for each size\n"
+              << "  --sweep-db <path>  In a sweep, insert rows into this SQLite database instead of printing JSON\n"
+              << "  --sweep-out <path> In a sweep, append fixed-width binary records to this file instead\n"
+              << "                     (read by python/analyze_modular_results.py)\n"
+              << "  --pipeline         Benchmark the full pipeline: producer threads hash their keys and\n"
+              << "                     route them through queues to consumer threads that fill the shards\n"
+              << "  --consumers <n>    Number of consumer threads in pipeline mode (default: --threads)\n"
+              << "  --stream           Generate the keys in fixed-size batches while they are hashed instead\n"
+              << "                     of storing them first; memory stays constant in the iterations\n"
               << "  --help             Show this help message\n";
 }
 
@@ -176,15 +313,8 @@ void print_usage(const char* program) {
 int main(int argc, char* argv[]) {
     // Set a fixed random seed for reproducibility
     srand(42);
-    if (argc < 3) {
-        print_usage(argv[0]);
-        return 1;
-    }
-    
-    // Parse command line arguments
-    uint64_t table_size = std::stoull(argv[1]);
-    uint64_t num_iterations = std::stoull(argv[2]);
-    
+    uint64_t table_size = 0;
+    uint64_t num_iterations = 0;
     int num_threads = std::thread::hardware_concurrency();
     bool force_sqlite = false;
     bool compare_mode = false;
@@ -193,28 +323,60 @@ int main(int argc, char* argv[]) {
     std::string specific_algorithm;
     std::string collision_db_path;
     int hash_bits = 0;  // 0 means auto-detect based on table size
+    Reduction reduction = Reduction::Modulo;
+    std::string sweep_spec;
+    double target_collisions = 0;
+    std::string sweep_db_path;
+    std::string sweep_out_path;
+    bool pipeline_mode = false;
+    int num_consumers = 0;  // 0 means one per producer
+    std::vector<int> affinity;
+    size_t avalanche_stride = 100;
+    size_t sac_input_bits = 0;
+    bool perf_counters = false;
+    bool stream_mode = false;
     
     // Parse options
     static struct option long_options[] = {
         {"threads", required_argument, 0, 't'},
+        {"affinity", required_argument, 0, 'f'},
         {"force-sqlite", no_argument, 0, 's'},
         {"compare", no_argument, 0, 'c'},
         {"algorithm", required_argument, 0, 'a'},
         {"json", no_argument, 0, 'j'},
         {"metrics", no_argument, 0, 'm'},
+        {"avalanche-stride", required_argument, 0, 'v'},
+        {"sac", no_argument, 0, 'x'},
+        {"perf-counters", no_argument, 0, 'e'},
         {"collision-db", required_argument, 0, 'd'},
         {"hash-bits", required_argument, 0, 'b'},
+        {"reduction", required_argument, 0, 'r'},
+        {"sweep", required_argument, 0, 'w'},
+        {"target-collisions", required_argument, 0, 'k'},
+        {"sweep-db", required_argument, 0, 'o'},
+        {"sweep-out", required_argument, 0, 'O'},
+        {"pipeline", no_argument, 0, 'p'},
+        {"consumers", required_argument, 0, 'n'},
+        {"stream", no_argument, 0, 'S'},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
     };
     
     int option_index = 0;
     int c;
-    while ((c = getopt_long(argc, argv, "t:sca:jmd:b:h", long_options, &option_index)) != -1) {
+    while ((c = getopt_long(argc, argv, "t:f:sca:jmv:xed:b:r:w:k:o:O:pn:Sh", long_options, &option_index)) != -1) {
         switch (c) {
             case 't':
                 num_threads = std::stoi(optarg);
                 break;
+            case 'f':
+                try {
+                    affinity = ThreadPool::parse_cpu_list(optarg);
+                } catch (const std::invalid_argument& e) {
+                    std::cerr << "Error: " << e.what() << "\n";
+                    return 1;
+                }
+                break;
             case 's':
                 force_sqlite = true;
                 break;
@@ -230,6 +392,21 @@ int main(int argc, char* argv[]) {
             case 'm':
                 collect_metrics = true;
                 break;
+            case 'v':
+                avalanche_stride = std::stoull(optarg);
+                if (avalanche_stride == 0) {
+                    std::cerr << "Error: avalanche-stride must be at least 1\n";
+                    return 1;
+                }
+                collect_metrics = true;
+                break;
+            case 'x':
+                sac_input_bits = 512;
+                collect_metrics = true;
+                break;
+            case 'e':
+                perf_counters = true;
+                break;
             case 'd':
                 collision_db_path = optarg;
                 collect_metrics = true;  // Enabling collision db implies metrics
@@ -241,6 +418,39 @@ int main(int argc, char* argv[]) {
                     return 1;
                 }
                 break;
+            case 'r':
+                try {
+                    reduction = GoldenHash::parse_reduction(optarg);
+                } catch (const std::invalid_argument& e) {
+                    std::cerr << "Error: " << e.what() << "\n";
+                    return 1;
+                }
+                break;
+            case 'w':
+                sweep_spec = optarg;
+                break;
+            case 'k':
+                target_collisions = std::stod(optarg);
+                break;
+            case 'o':
+                sweep_db_path = optarg;
+                break;
+            case 'O':
+                sweep_out_path = optarg;
+                break;
+            case 'p':
+                pipeline_mode = true;
+                break;
+            case 'n':
+                num_consumers = std::stoi(optarg);
+                if (num_consumers <= 0 || num_consumers > 64) {
+                    std::cerr << "Error: consumers must be between 1 and 64\n";
+                    return 1;
+                }
+                break;
+            case 'S':
+                stream_mode = true;
+                break;
             case 'h':
                 print_usage(argv[0]);
                 return 0;
@@ -249,6 +459,82 @@ int main(int argc, char* argv[]) {
                 return 1;
         }
     }
+
+    if (!sweep_spec.empty()) {
+        // Sweep mode: the only positional argument is the optional number of keys
+        if (optind < argc) {
+            num_iterations = std::stoull(argv[optind]);
+        }
+        try {
+            SweepRange range = SweepRange::parse(sweep_spec);
+            std::unique_ptr<SweepSink> sink;
+            if (!sweep_db_path.empty() && !sweep_out_path.empty()) {
+                throw std::invalid_argument("--sweep-db and --sweep-out are mutually exclusive");
+            } else if (!sweep_out_path.empty()) {
+                sink = std::make_unique<BinarySweepSink>(sweep_out_path);
+            } else if (!sweep_db_path.empty()) {
+                sink = std::make_unique<SQLiteSweepSink>(sweep_db_path);
+            } else {
+                sink = std::make_unique<JsonLinesSweepSink>(std::cout);
+            }
+            run_sweep(range, num_iterations, target_collisions, reduction, num_threads, *sink);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    // Parse positional arguments
+    if (argc - optind < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    table_size = std::stoull(argv[optind]);
+    num_iterations = std::stoull(argv[optind + 1]);
+    if (!specific_algorithm.empty()) {
+        try {
+            if (!find_hash_algorithm(specific_algorithm).supported()) {
+                std::cerr << "Error: " << specific_algorithm << " is not available in this build or on this CPU\n";
+                return 1;
+            }
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    // One hasher serves every algorithm run and the JSON report; built first so that an unsupported size fails early
+    std::shared_ptr<const GoldenHash> hasher;
+    try {
+        hasher = GoldenHash::shared(table_size, 0, reduction);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    if (perf_counters) {
+        // Fail before any test data is generated if the counters are not available
+        try {
+            PerfCounters probe;
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    if (pipeline_mode && collect_metrics) {
+        std::cerr << "Error: --pipeline measures throughput only and cannot be combined with --metrics\n";
+        return 1;
+    }
+    if (stream_mode && pipeline_mode) {
+        std::cerr << "Error: --pipeline partitions stored test data and cannot be combined with --stream\n";
+        return 1;
+    }
+    if (stream_mode && !collision_db_path.empty()) {
+        std::cerr << "Error: collision records need the stored test data and cannot be combined with --stream\n";
+        return 1;
+    }
+    if (num_consumers == 0) {
+        num_consumers = std::clamp(num_threads, 1, 64);
+    }
     
     // Determine whether to use SQLite based on memory requirements
     bool use_sqlite = force_sqlite;
@@ -279,18 +565,50 @@ int main(int argc, char* argv[]) {
         std::cout << "Testing with table size: " << table_size 
                   << ", iterations: " << num_iterations
                   << ", threads: " << num_threads
-                  << ", storage: " << (use_sqlite ? "SQLite" : "Memory") << "\n\n";
+                  << ", storage: " << (use_sqlite ? "SQLite" : "Memory")
+                  << (stream_mode ? ", keys streamed" : "") << "\n\n";
+    }
+
+    // One pool serves every algorithm. Every partition gets a metrics worker,
+    // and those run alongside the benchmarks only when --affinity pins every
+    // worker to a CPU of its own; unpinned threads may share a core (or SMT
+    // siblings), so otherwise the metrics pass runs after the benchmarks so
+    // that it does not skew their timings.
+    // Workers are pinned round-robin over the list, so drop repeated CPUs first
+    std::vector<int> distinct_cpus;
+    for (int cpu : affinity) {
+        if (std::find(distinct_cpus.begin(), distinct_cpus.end(), cpu) == distinct_cpus.end()) {
+            distinct_cpus.push_back(cpu);
+        }
+    }
+    bool metrics_on_own_cores = collect_metrics && !distinct_cpus.empty()
+                                && distinct_cpus.size() >= 2 * static_cast<size_t>(num_threads);
+    std::unique_ptr<ThreadPool> pool;
+    try {
+        pool = std::make_unique<ThreadPool>(num_threads * (metrics_on_own_cores ? 2 : 1), distinct_cpus);
+    } catch (const std::system_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
     }
 
     // Generate the test data, split into the number of threads so each thread has its own data it is responsible for
-    std::vector<std::unique_ptr<TestData>> test_data = TestDataGenerator::generate(num_iterations, num_threads, use_sqlite, json_output);
+    // In stream mode the keys are generated again for every algorithm, from one seed so that all see the same keys
+    std::vector<std::unique_ptr<TestData>> test_data;
+    uint64_t stream_seed = 0;
+    if (stream_mode) {
+        std::random_device rd;
+        stream_seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+    } else {
+        test_data = TestDataGenerator::generate(num_iterations, num_threads, use_sqlite, json_output);
+    }
+
 
-    
     // Lambda to run test for a specific algorithm
     auto run_algorithm_test = [&](const std::string& algo) -> ComparisonResult {
-        // Create 64 shards
+        // Create 64 shards, each sized for its share of the distinct hashes
         std::vector<MapShard*> shards;
         shards.reserve(64);
+        uint64_t expected_keys_per_shard = std::min(table_size, num_iterations) / 64 + 1;
         
         for (int i = 0; i < 64; ++i) {
             if (use_sqlite) {
@@ -300,28 +618,72 @@ int main(int argc, char* argv[]) {
                 std::string filename = "data/" + algo + "_shard_" + std::to_string(i) + ".db";
                 shards.push_back(new SQLiteShard(filename));
             } else {
-                shards.push_back(new HashMapShard());
+                shards.push_back(new FlatCountingShard(expected_keys_per_shard));
+            }
+        }
+
+        if (pipeline_mode) {
+            if (!json_output) {
+                std::cout << "Running pipeline benchmark for " << algo << " (" << num_iterations << " keys, "
+                          << num_threads << " producers, " << num_consumers << " consumers)...\n";
+            }
+            std::vector<TestData*> partitions;
+            for (auto& data : test_data) {
+                partitions.push_back(data.get());
+            }
+            PipelineBenchmark pipeline(shards, *hasher, algo, table_size, num_consumers);
+            PipelineResult pipeline_result = pipeline.run(partitions);
+            print_pipeline_report(pipeline_result, algo, json_output);
+            for (auto* shard : shards) {
+                delete shard;
+            }
+            ComparisonResult result{};
+            result.algorithm = algo;
+            result.table_size = table_size;
+            result.ns_per_hash = pipeline_result.ns_per_hash;
+            result.throughput_mbs = pipeline_result.throughput_mbs;
+            result.total_time_ms = pipeline_result.elapsed_ms;
+            return result;
+        }
+
+        // Without collision records no partner indices are needed, so every runner
+        // counts collisions in one shared bitmap of the table when it fits in memory
+        std::shared_ptr<DenseHashSet> dense_buckets;
+        if (collect_metrics && collision_db_path.empty() && table_size / 8 < get_available_memory() / 2) {
+            dense_buckets = std::make_shared<DenseHashSet>(table_size);
+        }
+
+        // One collision store and one 64-bit analysis serve the runners of every partition
+        std::shared_ptr<CollisionStore> collision_store;
+        std::shared_ptr<Hash64Analyzer> hash64_analyzer;
+        if (collect_metrics && !collision_db_path.empty()) {
+            // Create directory if needed
+            std::filesystem::path p(collision_db_path);
+            if (p.has_parent_path()) {
+                std::filesystem::create_directories(p.parent_path());
             }
+            collision_store = Hash64Analyzer::open_store(collision_db_path);
+        }
+        if (collect_metrics && hash_bits == 64) {
+            hash64_analyzer = std::make_shared<Hash64Analyzer>(collision_store, num_iterations);
         }
 
         std::vector<std::unique_ptr<TestRunner>> runners;
         runners.reserve(num_threads);
-        GoldenHash hasher(table_size);
         for (int i = 0; i < num_threads; ++i) {
-            runners.emplace_back(std::make_unique<TestRunner>(shards, test_data[i].get(), hasher, algo, table_size));
+            TestData* partition = stream_mode ? nullptr : test_data[i].get();
+            runners.emplace_back(std::make_unique<TestRunner>(shards, partition, *hasher, algo, table_size));
             
-            // Enable metrics collection if requested
-            if (collect_metrics && i == 0) {  // Only collect metrics on first thread
-                std::string db_path = collision_db_path;
-                if (!db_path.empty()) {
-                    // Create directory if needed
-                    std::filesystem::path p(db_path);
-                    if (p.has_parent_path()) {
-                        std::filesystem::create_directories(p.parent_path());
-                    }
-                }
-                bool analyze_64bit = (hash_bits == 64);
-                runners[i]->enable_metrics(256, db_path, analyze_64bit);
+            // Every runner analyzes its own partition
+            if (collect_metrics) {
+                uint64_t first_index = TestDataGenerator::partition(num_iterations, num_threads, i).first;
+                runners[i]->enable_metrics(256, collision_store, hash64_analyzer, dense_buckets, avalanche_stride,
+                                           sac_input_bits, first_index);
+            }
+        }
+        if (perf_counters) {
+            for (auto& runner : runners) {
+                runner->enable_perf_counters();
             }
         }
 
@@ -330,26 +692,45 @@ int main(int argc, char* argv[]) {
             std::cout << "Running performance benchmarks for " << algo << " (" << num_iterations << " iterations across " 
                       << num_threads << " threads)...\n";
         }
-        for (auto& runner : runners) {
-            runner->run_performance_benchmark();
+        if (collect_metrics && !json_output) {
+            std::cout << "Collecting quality metrics for " << algo
+                      << (stream_mode ? " as the keys are generated"
+                                      : metrics_on_own_cores ? " on separate cores" : " after the benchmarks") << "...\n";
         }
-        
-        // Run metrics collection if enabled
-        if (collect_metrics) {
-            if (!json_output) {
-                std::cout << "Collecting quality metrics for " << algo << "...\n";
+        if (stream_mode) {
+            // Every runner consumes its share of the keys while a generator thread of its own produces them
+            pool->run_on_workers(num_threads, [&](size_t worker) {
+                auto [start_idx, end_idx] = TestDataGenerator::partition(num_iterations, num_threads, static_cast<int>(worker));
+                TestStream stream(start_idx, end_idx, stream_seed + worker);
+                runners[worker]->run_stream(stream);
+            });
+        } else if (metrics_on_own_cores) {
+            // Workers num_threads and up are reserved for the metrics pass
+            pool->run_on_workers(2 * num_threads, [&](size_t worker) {
+                if (worker < runners.size()) {
+                    runners[worker]->run_performance_benchmark();
+                } else {
+                    runners[worker - runners.size()]->run_metrics_collection();
+                }
+            });
+        } else {
+            pool->run_on_workers(num_threads, [&](size_t worker) {
+                runners[worker]->run_performance_benchmark();
+            });
+            if (collect_metrics) {
+                pool->run_on_workers(num_threads, [&](size_t worker) {
+                    runners[worker]->run_metrics_collection();
+                });
             }
-            runners[0]->run_metrics_collection();
-        }
-
-        // Wait for all performance benchmarks to complete
-        for (auto& runner : runners) {
-            runner->performance_benchmark_complete_.wait(false);
         }
-        
-        // Wait for metrics collection if enabled
         if (collect_metrics) {
-            runners[0]->metrics_collection_complete_.wait(false);
+            // Reduce the per-partition metrics into the first runner
+            std::vector<TestRunner*> others;
+            for (size_t i = 1; i < runners.size(); ++i) {
+                others.push_back(runners[i].get());
+            }
+            runners[0]->merge_metrics(others, *pool);
+            runners[0]->store_test_run();
         }
         
         // Aggregate results from all runners
@@ -371,6 +752,14 @@ int main(int argc, char* argv[]) {
             result.ns_per_hash += runner_result.ns_per_hash;
             result.throughput_mbs += runner_result.throughput_mbs;
             result.total_time_ms = std::max(result.total_time_ms, runner_result.total_time_ms);
+            if (runner_result.perf_collected) {
+                if (result.perf_collected) {
+                    result.perf.merge(runner_result.perf);
+                } else {
+                    result.perf = runner_result.perf;
+                    result.perf_collected = true;
+                }
+            }
         }
 
         result.ns_per_hash /= runners.size();
@@ -388,6 +777,9 @@ int main(int argc, char* argv[]) {
             auto metrics_result = runners[0]->get_result();
             result.avalanche_score = metrics_result.avalanche_score;
             result.avalanche_bias = metrics_result.avalanche_bias;
+            result.sac_bias = metrics_result.sac_bias;
+            result.bic_max_correlation = metrics_result.bic_max_correlation;
+            result.sac_collected = metrics_result.sac_collected;
             result.chi_squared = metrics_result.chi_squared;
             result.uniformity_score = metrics_result.uniformity_score;
             result.collision_ratio = metrics_result.collision_ratio;
@@ -407,26 +799,24 @@ int main(int argc, char* argv[]) {
     
     if (compare_mode && !json_output) {
         // Test all algorithms
-        std::vector<std::string> algorithms = {"goldenhash", "xxhash64", "sha256", "aes-cmac"};
         std::vector<ComparisonResult> results;
-        for (const auto& algo : algorithms) {
-            ComparisonResult algo_result = run_algorithm_test(algo);
+        for (const HashAlgorithm& algorithm : hash_algorithms()) {
+            if (!algorithm.supported()) continue;
+            ComparisonResult algo_result = run_algorithm_test(std::string(algorithm.name));
             results.push_back(algo_result);
         }
         display_comparison_table(results);
     } else if (!specific_algorithm.empty()) {
         // Test specific algorithm
         auto result = run_algorithm_test(specific_algorithm);
-        if (json_output && specific_algorithm == "goldenhash") {
-            GoldenHash hasher(table_size);
-            output_json_results(result, table_size, num_iterations, hasher);
+        if (json_output && !pipeline_mode && specific_algorithm == "goldenhash") {
+            output_json_results(result, table_size, num_iterations, *hasher);
         }
     } else {
         // Default to goldenhash
         auto result = run_algorithm_test("goldenhash");
-        if (json_output) {
-            GoldenHash hasher(table_size);
-            output_json_results(result, table_size, num_iterations, hasher);
+        if (json_output && !pipeline_mode) {
+            output_json_results(result, table_size, num_iterations, *hasher);
         }
     }
     
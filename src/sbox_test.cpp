@@ -3,6 +3,27 @@
 #include <vector>
 #include <bitset>
 
+/**
+ * @brief Best-of-5 time to hash every key of a corpus once
+ * @return Nanoseconds per hash
+ */
+static double time_hashing(const goldenhash::GoldenHash& hasher, const std::vector<std::vector<uint8_t>>& corpus) {
+    double best = 0;
+    uint64_t sink = 0;
+    for (int run = 0; run < 5; run++) {
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& key : corpus) {
+            sink += hasher.hash(key.data(), key.size());
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / corpus.size();
+        if (run == 0 || ns < best) best = ns;
+    }
+    // Keep the loop from being optimized away
+    if (sink == 42) std::cout << "";
+    return best;
+}
+
 int main() {
     std::cout << "S-Box Analysis for Different Table Sizes\n";
     std::cout << "========================================\n";
@@ -50,6 +71,47 @@ int main() {
         hasher.analyze_sboxes();
         std::cout << "----------------------------------------\n\n";
     }
-    
+
+    // Smaller S-box geometries leave L1D to the caller at some cost in quality
+    std::cout << "\nS-Box Geometry Tradeoff (N = 1000003)\n";
+    std::cout << "=====================================\n";
+    const uint64_t N = 1000003;
+    const std::vector<goldenhash::SboxGeometry> geometries = {
+        {8, 12}, {4, 12}, {2, 12}, {1, 12}, {8, 10}, {2, 10}, {8, 8}
+    };
+    const std::vector<std::vector<uint8_t>> corpus = goldenhash::GoldenHash::generate_test_corpus(200000);
+    std::vector<goldenhash::CollectiveMetrics> metrics;
+    std::vector<double> speed;
+    for (const goldenhash::SboxGeometry& geometry : geometries) {
+        goldenhash::GoldenHash hasher(N, 0, goldenhash::Reduction::Modulo, geometry);
+        hasher.analyze_sboxes();
+        metrics.push_back(goldenhash::GoldenHash::run_tests_for(hasher, corpus));
+        speed.push_back(time_hashing(hasher, corpus));
+    }
+
+    std::cout << "\n" << std::left << std::setw(10) << "Geometry"
+              << std::setw(10) << "Bytes"
+              << std::setw(12) << "Avalanche"
+              << std::setw(12) << "Chi^2"
+              << std::setw(12) << "Coll ratio"
+              << std::setw(10) << "Max load"
+              << std::setw(10) << "ns/hash"
+              << "\n";
+    std::cout << std::string(76, '-') << "\n";
+    for (size_t i = 0; i < geometries.size(); i++) {
+        std::cout << std::left << std::setw(10) << goldenhash::GoldenHash::sbox_geometry_name(geometries[i])
+                  << std::setw(10) << geometries[i].bytes()
+                  << std::fixed << std::setprecision(4)
+                  << std::setw(12) << metrics[i].avalanche_score
+                  << std::setw(12) << metrics[i].chi_square
+                  << std::setw(12) << metrics[i].collision_ratio
+                  << std::setw(10) << metrics[i].max_bucket_load
+                  << std::setprecision(2) << std::setw(10) << speed[i]
+                  << "\n";
+    }
+    std::cout << "\nAvalanche ~0.5, Chi^2 ~1.0 and collision ratio ~1.0 are ideal. ns/hash is\n"
+              << "measured with the S-boxes hot in an otherwise idle cache; the smaller\n"
+              << "geometries gain most when the caller's own data competes for L1D.\n";
+
     return 0;
 }
\ No newline at end of file